@@ -0,0 +1,38 @@
+/*********************************************************************
+ * @file  benchClearScreen.cpp
+ *
+ * @brief Cost of clearing the screen with escape sequences against
+ *        running the "clear"/"cls" system command
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "osUtils.h"
+
+#include <iostream>
+
+using osUtils::clearScreen;
+using osUtils::ClearMethod;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using benchUtils::NullStream;
+
+int main() {
+    constexpr size_t escapeRepetitions = 1'000'000;
+    constexpr size_t systemRepetitions = 100;
+
+    NullStream os{};
+    auto escapeTime = averageMicroseconds(escapeRepetitions, [&os]() {
+        clearScreen(os, ClearMethod::EscapeSequence);
+    });
+
+    // The system command writes to the real console, so results are printed afterwards
+    auto systemTime = averageMicroseconds(systemRepetitions, []() {
+        clearScreen(std::cout, ClearMethod::SystemCommand);
+    });
+
+    printHeader("Clear screen");
+    printResult("EscapeSequence", escapeRepetitions, escapeTime);
+    printResult("SystemCommand", systemRepetitions, systemTime);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*********************************************************************
+ * @file  benchDelimiterScan.cpp
+ *
+ * @brief Time per byte to find every delimiter and newline in prose by
+ *        splitting it one word at a time with splitByDelimiter and find,
+ *        against scanDelimiters with each comparison path
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "svUtils.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+using svUtils::DelimiterPositions;
+using svUtils::ScanPath;
+using svUtils::scanDelimiters;
+using svUtils::splitByDelimiter;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using std::string;
+using std::string_view;
+
+// Words of 1 to 12 letters with a paragraph break now and then, like menu details
+static string makeProse(size_t size) {
+    std::mt19937 generator{ 3 };
+    string text{};
+    text.reserve(size);
+    while (text.size() < size) {
+        text.append(1 + generator() % 12, static_cast<char>('a' + generator() % 26));
+        text += 0 == generator() % 40 ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+// How wrapToLength found them before: one splitByDelimiter per word and a find for newlines in it
+static void findPerWord(string_view text, string_view delimiter, DelimiterPositions& positions) {
+    positions.delimiters.clear();
+    positions.newLines.clear();
+    string_view word{}, rest{ text };
+    while (!rest.empty()) {
+        auto wordStart = text.size() - rest.size();
+        auto lengthBefore = rest.size();
+        std::tie(word, rest) = splitByDelimiter(rest, delimiter);
+        for (auto newLine = word.find('\n'); string_view::npos != newLine; newLine = word.find('\n', newLine + 1)) {
+            positions.newLines.push_back(wordStart + newLine);
+        }
+        if (word.size() != lengthBefore) positions.delimiters.push_back(wordStart + word.size());
+    }
+}
+
+static void printPerByte(const string& name, size_t size, double microseconds) {
+    std::printf("%-40s %12zu %16.3f ns/byte\n", name.c_str(), size, 1000 * microseconds / static_cast<double>(size));
+}
+
+int main() {
+    std::printf("best scan path: %s\n",
+        ScanPath::AVX2 == svUtils::bestScanPath() ? "AVX2" : ScanPath::SSE2 == svUtils::bestScanPath() ? "SSE2" : "scalar");
+
+    DelimiterPositions expected{}, positions{};
+    for (size_t megabytes : { 1, 100 }) {
+        auto text = makeProse(megabytes << 20);
+        auto repetitions = megabytes > 1 ? 2 : 50;
+        printHeader("Delimiters and newlines in " + std::to_string(megabytes) + " MB of prose");
+
+        printPerByte("splitByDelimiter and find per word", text.size(),
+            averageMicroseconds(repetitions, [&]() { findPerWord(text, " ", expected); }));
+        for (auto [name, path] : { std::pair{ "scanDelimiters scalar", ScanPath::Scalar }, { "scanDelimiters SSE2", ScanPath::SSE2 }, { "scanDelimiters AVX2", ScanPath::AVX2 } }) {
+            printPerByte(name, text.size(), averageMicroseconds(repetitions, [&]() { scanDelimiters(text, " ", positions, path); }));
+            if (positions.delimiters != expected.delimiters || positions.newLines != expected.newLines) std::puts("unexpected");
+        }
+        std::printf("%zu delimiters, %zu newlines\n", expected.delimiters.size(), expected.newLines.size());
+    }
+    return 0;
+}
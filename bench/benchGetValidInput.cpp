@@ -0,0 +1,214 @@
+/*********************************************************************
+ * @file  benchGetValidInput.cpp
+ *
+ * @brief Latency and heap allocations per input of the type erased
+ *        getValidInput against the template pipeline
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "userInput.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+using ioUtils::getValidInput;
+using ioUtils::hasUnextractedInput;
+using ioUtils::ignoreInputLine;
+using ioUtils::resetInputStream;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using benchUtils::NullStream;
+using std::apply;
+using std::function;
+using std::istream;
+using std::istringstream;
+using std::make_optional;
+using std::make_tuple;
+using std::optional;
+using std::ostream;
+using std::string;
+using std::string_view;
+using std::tuple;
+using std::tuple_cat;
+
+/**
+* getValidInput before the template pipeline: every stage is type erased behind a function
+* and the input is copied into argument tuples on every attempt
+*/
+template <
+    typename T,
+    typename... InputValidationArgTypes,
+    typename... ConversionArgTypes,
+    typename... OutputValidationArgTypes
+>
+    requires std::is_default_constructible_v<T>
+static optional<T> typeErasedGetValidInput(
+    function<void(ostream&)> printPrompt,
+    function<void(ostream&)> printInvalidInputMessage,
+    function<void(ostream&)> printErrorMessage,
+    function<bool(string_view, InputValidationArgTypes...)> isValidInput,
+    tuple<InputValidationArgTypes...> inputValidationArgs,
+    function<T(string_view, ConversionArgTypes...)> convertStringToOutput,
+    tuple<ConversionArgTypes...> conversionArgs,
+    function<bool(const T&, OutputValidationArgTypes...)> isValidOutput,
+    tuple<OutputValidationArgTypes...> outputValidationArgs,
+    istream& is,
+    ostream& os
+){
+
+    auto printInvalidInputAndRepeatPrompt =
+        [
+            &printInvalidInputMessage,
+            &printPrompt
+        ](ostream& os) -> void{
+            printInvalidInputMessage(os);
+            printPrompt(os);
+    };
+
+    // Prompt the User for Input
+    printPrompt(os);
+
+    T output{};
+    string inputString{};
+    while (hasUnextractedInput(is)) // Loop until user enters a valid input
+    {
+        is >> inputString;
+
+        if (!is) { // If the previous extraction failed
+            resetInputStream(is);
+            printInvalidInputAndRepeatPrompt(os);
+            continue;
+        }
+
+        try {
+            // Validate Input String
+            auto inputValidationAllArgs = tuple_cat(make_tuple(inputString), inputValidationArgs);
+            if (!apply(isValidInput, inputValidationAllArgs)) { // Invalid input
+                resetInputStream(is);
+                printInvalidInputAndRepeatPrompt(os);
+                continue;
+            }
+
+            // Convert to Output
+            auto conversionAllArgs = tuple_cat(make_tuple(inputString), conversionArgs);
+            output = apply(convertStringToOutput, conversionAllArgs);
+
+            // Validate Output
+            auto outputValidationAllArgs = tuple_cat(make_tuple(output), outputValidationArgs);
+            if (!apply(isValidOutput, outputValidationAllArgs)) { // Invalid input
+                resetInputStream(is);
+                printInvalidInputAndRepeatPrompt(os);
+                continue;
+            }
+        }catch (...) {
+            resetInputStream(is);
+            printInvalidInputAndRepeatPrompt(os);
+            continue;
+        }
+
+        // Ignore input line before returning
+        ignoreInputLine(is);
+        return make_optional(output);
+    }
+
+
+    printErrorMessage(os);
+    return {};
+}
+
+static size_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* memory = std::malloc(size > 0 ? size : 1)) return memory;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+// Both pipelines use the same stages so only the plumbing between them is measured
+static constexpr int lowerBound = 0;
+static constexpr int upperBound = 100;
+static void printInvalidInputMessage(ostream& os) { os << "The number provided was invalid.\n"; }
+static void printErrorMessage(ostream& os) { os << "No valid number was provided.\n"; }
+static bool isValidInput(string_view input) { return !input.empty(); }
+static int toNumber(string_view input) {
+    int number{};
+    auto [end, error] = std::from_chars(input.data(), input.data() + input.size(), number);
+    if (error != std::errc{} || end != input.data() + input.size()) throw "String is not a valid integer";
+    return number;
+}
+static bool isInRange(const int& number, int lowerBound, int upperBound) {
+    return number >= lowerBound && number <= upperBound;
+}
+
+static string makeInput(size_t inputCount) {
+    string input{};
+    // Every third input is rejected once; some tokens are longer than the small string buffer
+    for (size_t line = 0; line < inputCount; ++line) {
+        if (line % 3 == 0) input += "abc\n";
+        input += (line % 2 == 0) ? "42\n" : "00000000000000000000042\n";
+    }
+    return input;
+}
+
+template <typename F>
+static void benchPipeline(const char* name, size_t inputCount, F&& readOne) {
+    NullStream os{};
+    istringstream is{ makeInput(inputCount) };
+    allocationCount = 0;
+    auto time = averageMicroseconds(inputCount, [&is, &os, &readOne]() { readOne(is, os); });
+    printResult(name, inputCount, time);
+    std::printf("%-40s %12s %16.3f allocations per input\n", "", "",
+        static_cast<double>(allocationCount) / static_cast<double>(inputCount));
+}
+
+int main() {
+    printHeader("getValidInput per input");
+    for (size_t inputCount : { 10'000, 100'000 }) {
+        // Captures the prompt and bounds like getNumberInRange does
+        string_view prompt{ "Please enter a number in the range " };
+        auto printPrompt = [prompt, lower = lowerBound, upper = upperBound](ostream& os) {
+            os << prompt << '[' << lower << ',' << upper << ")\n";
+        };
+        benchPipeline("type erased", inputCount, [&printPrompt](istringstream& is, ostream& os) {
+            typeErasedGetValidInput(
+                function<void(ostream&)>(printPrompt),
+                function<void(ostream&)>(printInvalidInputMessage),
+                function<void(ostream&)>(printErrorMessage),
+                function<bool(string_view)>(isValidInput),
+                tuple<>{},
+                function<int(string_view)>(toNumber),
+                tuple<>{},
+                function<bool(const int&, int, int)>(isInRange),
+                tuple<int, int>{ lowerBound, upperBound },
+                is,
+                os
+            );
+        });
+        benchPipeline("template pipeline", inputCount, [&printPrompt](istringstream& is, ostream& os) {
+            getValidInput(
+                printPrompt,
+                printInvalidInputMessage,
+                printErrorMessage,
+                isValidInput,
+                toNumber,
+                [](const int& number) { return isInRange(number, lowerBound, upperBound); },
+                is,
+                os
+            );
+        });
+    }
+    return 0;
+}
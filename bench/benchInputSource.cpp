@@ -0,0 +1,141 @@
+/*********************************************************************
+ * @file  benchInputSource.cpp
+ *
+ * @brief Throughput of reading a 100 MB file of menu selections through
+ *        an ifstream against an FdInputSource, token by token and
+ *        through the getValidInput pipeline
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "inputSource.h"
+#include "numberParser.h"
+#include "userInput.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#if defined(_WIN32)
+    #include <fcntl.h>
+    #include <io.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using ioUtils::FdInputSource;
+using ioUtils::StreamInputSource;
+using ioUtils::getValidInput;
+using ioUtils::parseNumber;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using benchUtils::NullStream;
+using std::optional;
+using std::ostream;
+using std::string;
+using std::string_view;
+
+static constexpr size_t FILE_SIZE = size_t{ 100 } << 20;
+
+// One selection per line as a script would pipe them in; every seventh is out of range or not a number
+static void writeSelections(const std::filesystem::path& path) {
+    std::ofstream file{ path, std::ios::binary };
+    string chunk{};
+    for (size_t line = 0; chunk.size() < (size_t{ 1 } << 20); ++line) {
+        if (line % 7 == 3) chunk += line % 2 ? "12\n" : "x\n";
+        else chunk += static_cast<char>('1' + line % 9), chunk += '\n';
+    }
+    for (size_t written = 0; written < FILE_SIZE; written += chunk.size()) file << chunk;
+}
+
+static int openForReading(const std::filesystem::path& path) {
+    #if defined(_WIN32)
+        return _open(path.string().c_str(), _O_RDONLY | _O_BINARY);
+    #else
+        return open(path.c_str(), O_RDONLY);
+    #endif
+}
+
+static void closeFile(int fd) {
+    #if defined(_WIN32)
+        _close(fd);
+    #else
+        close(fd);
+    #endif
+}
+
+// Reads selections in [1, 9] until the input ends; returns how many were accepted
+template <ioUtils::InputSource Source>
+static size_t readAllSelections(Source& source) {
+    NullStream os{};
+    size_t accepted = 0;
+    while (getValidInput(
+        [](ostream& os) { os << "Please enter a number in the range [1,9]\n"; },
+        [](ostream& os) { os << "The number provided was invalid.\n"; },
+        [](ostream&) {},
+        [](string_view) { return true; },
+        parseNumber<int>,
+        [](const optional<int>& number) { return number.has_value() && *number >= 1 && *number <= 9; },
+        source,
+        os
+    )) {
+        ++accepted;
+    }
+    return accepted;
+}
+
+static void printThroughput(double microseconds) {
+    std::printf("%-40s %12s %16.1f MB/s\n", "", "", static_cast<double>(FILE_SIZE) / microseconds);
+}
+
+int main() {
+    auto path = std::filesystem::temp_directory_path() / "benchInputSource.selections";
+    writeSelections(path);
+
+    printHeader("Tokens of a 100 MB selection file");
+    size_t streamTokens = 0, fdTokens = 0;
+    auto time = averageMicroseconds(1, [&path, &streamTokens]() {
+        std::ifstream file{ path, std::ios::binary };
+        string token{};
+        while (file >> token) ++streamTokens;
+    });
+    printResult("ifstream >> string", streamTokens, time);
+    printThroughput(time);
+
+    time = averageMicroseconds(1, [&path, &fdTokens]() {
+        int fd = openForReading(path);
+        FdInputSource source{ fd };
+        while (source.readToken()) ++fdTokens;
+        closeFile(fd);
+    });
+    printResult("FdInputSource::readToken", fdTokens, time);
+    printThroughput(time);
+    if (streamTokens != fdTokens) std::puts("unexpected");
+
+    printHeader("getValidInput over a 100 MB selection file");
+    size_t streamAccepted = 0, fdAccepted = 0;
+    time = averageMicroseconds(1, [&path, &streamAccepted]() {
+        std::ifstream file{ path, std::ios::binary };
+        StreamInputSource source{ file };
+        streamAccepted = readAllSelections(source);
+    });
+    printResult("istream adapter", streamAccepted, time);
+    printThroughput(time);
+
+    time = averageMicroseconds(1, [&path, &fdAccepted]() {
+        int fd = openForReading(path);
+        FdInputSource source{ fd };
+        fdAccepted = readAllSelections(source);
+        closeFile(fd);
+    });
+    printResult("FdInputSource", fdAccepted, time);
+    printThroughput(time);
+    if (streamAccepted != fdAccepted) std::puts("unexpected");
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*********************************************************************
+ * @file  benchIntegerString.cpp
+ *
+ * @brief Parsing, comparison and range checks of IntegerString against
+ *        the previous digit by digit representation, and its arithmetic
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "integerString.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using ioUtils::IntegerString;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+
+/**
+* The representation IntegerString had before it used limbs: the decimal digits without
+* sign and leading zeros, compared one character at a time
+*/
+class DigitStringInteger {
+    public:
+        explicit DigitStringInteger(string_view number) :
+            digits{ IntegerString::getAbsoluteValueString(number) },
+            negative{ IntegerString::isNegative(number) } {
+            if (digits.empty()) negative = false;
+        }
+
+        bool operator < (const DigitStringInteger& other) const {
+            if (&other == this) return false;
+            if (negative && !other.negative) return true;
+            if (!negative && other.negative) return false;
+            if (negative && other.negative) return !isSmaller(digits, other.digits);
+            return isSmaller(digits, other.digits);
+        }
+        bool operator > (const DigitStringInteger& other) const { return other < *this; }
+        bool operator <= (const DigitStringInteger& other) const { return !(*this > other); }
+        bool operator >= (const DigitStringInteger& other) const { return !(*this < other); }
+
+    private:
+        string digits;
+        bool negative;
+
+        static unsigned short charToDigit(char a) { return static_cast<unsigned short>(a - '0'); }
+
+        static bool isSmaller(string_view a, string_view b) {
+            if (a.empty() && b.empty()) return false;
+            if (a.length() != b.length()) return a.length() < b.length();
+            return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(),
+                [](char x, char y) { return charToDigit(x) < charToDigit(y); });
+        }
+};
+
+// Numbers of digitCount digits which share most of their leading digits, the worst case for comparisons
+static vector<string> makeNumbers(size_t digitCount, size_t count) {
+    std::mt19937 generator{ 7 };
+    std::uniform_int_distribution<int> digit{ 0, 9 };
+    string prefix(digitCount, '0');
+    for (auto& c : prefix) c = static_cast<char>('0' + digit(generator));
+    prefix[0] = '1';
+
+    vector<string> numbers(count, prefix);
+    for (auto& number : numbers) {
+        for (size_t index = digitCount - std::min<size_t>(digitCount, 4); index < digitCount; ++index) {
+            number[index] = static_cast<char>('0' + digit(generator));
+        }
+    }
+    return numbers;
+}
+
+template <class Integer>
+static double parseTime(const vector<string>& texts) {
+    return averageMicroseconds(20, [&texts]() {
+        for (auto& text : texts) {
+            Integer number{ text };
+            if (number < number) std::puts("unexpected");
+        }
+    }) / static_cast<double>(texts.size());
+}
+
+template <class Integer>
+static double rangeCheckTime(const vector<string>& texts) {
+    vector<Integer> numbers{};
+    for (auto& text : texts) numbers.emplace_back(text);
+    // Bounds at the 10th and 90th percentile
+    auto sorted = numbers;
+    std::sort(sorted.begin(), sorted.end());
+    auto lowerBound = sorted[sorted.size() / 10];
+    auto upperBound = sorted[sorted.size() * 9 / 10];
+    size_t inRange = 0;
+    auto time = averageMicroseconds(200, [&]() {
+        for (auto& number : numbers) inRange += number >= lowerBound && number <= upperBound ? 1 : 0;
+    }) / static_cast<double>(numbers.size());
+    if (0 == inRange) std::puts("unexpected");
+    return time;
+}
+
+int main() {
+    constexpr size_t count = 1000;
+
+    printHeader("IntegerString per number: digit string against limbs");
+    for (size_t digitCount : { 20, 200, 2000 }) {
+        auto texts = makeNumbers(digitCount, count);
+        auto digits = to_string(digitCount) + " digits";
+        printResult("parse digit string " + digits, count, parseTime<DigitStringInteger>(texts));
+        printResult("parse limbs " + digits, count, parseTime<IntegerString>(texts));
+        printResult("range check digit string " + digits, count, rangeCheckTime<DigitStringInteger>(texts));
+        printResult("range check limbs " + digits, count, rangeCheckTime<IntegerString>(texts));
+    }
+
+    printHeader("IntegerString arithmetic");
+    for (size_t digitCount : { 20, 200, 2000 }) {
+        auto texts = makeNumbers(digitCount, 2);
+        IntegerString a{ texts[0] }, b{ texts[1] };
+        auto digits = to_string(digitCount) + " digits";
+        printResult("add " + digits, digitCount, averageMicroseconds(10000, [&a, &b]() {
+            auto sum = a + b;
+            if (!sum.valid()) std::puts("unexpected");
+        }));
+        printResult("subtract " + digits, digitCount, averageMicroseconds(10000, [&a, &b]() {
+            auto difference = a - b;
+            if (!difference.valid()) std::puts("unexpected");
+        }));
+        printResult("multiply " + digits, digitCount, averageMicroseconds(digitCount > 200 ? 100 : 10000, [&a, &b]() {
+            auto product = a * b;
+            if (!product.valid()) std::puts("unexpected");
+        }));
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*********************************************************************
+ * @file  benchIntegerTokens.cpp
+ *
+ * @brief Time to split multi-megabyte lists of numbers into tokens and
+ *        check them with IntegerString::isInteger one token at a time,
+ *        against scanIntegerTokens with each classification path
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "integerString.h"
+#include "integerTokens.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using ioUtils::IntegerString;
+using ioUtils::IntegerToken;
+using ioUtils::ScanPath;
+using ioUtils::scanIntegerTokens;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+
+// Pasted identifiers: mostly long numbers, a few signed or mistyped, separated by spaces, commas and newlines
+static string makeInput(size_t size) {
+    std::mt19937_64 generator{ 11 };
+    string input{};
+    input.reserve(size + 32);
+    while (input.size() < size) {
+        auto value = generator();
+        if (0 == value % 17) input += '-';
+        input += to_string(value >> (value % 40));
+        if (0 == value % 101) input += 'O';
+        input += 0 == value % 8 ? ",\n" : " ";
+    }
+    return input;
+}
+
+static void scanTokenByToken(string_view input, vector<IntegerToken>& tokens) {
+    constexpr string_view separators = " ,\t\n\v\f\r";
+    tokens.clear();
+    for (auto start = input.find_first_not_of(separators); start != string_view::npos; start = input.find_first_not_of(separators, start)) {
+        auto end = std::min(input.find_first_of(separators, start), input.size());
+        tokens.push_back({ start, end - start, IntegerString::isInteger(input.substr(start, end - start)) });
+        start = end;
+    }
+}
+
+int main() {
+    std::printf("best scan path: %s\n",
+        ScanPath::AVX2 == ioUtils::bestScanPath() ? "AVX2" : ScanPath::SSE2 == ioUtils::bestScanPath() ? "SSE2" : "scalar");
+
+    vector<IntegerToken> tokens{};
+    tokens.reserve(1 << 24);
+    for (size_t megabytes : { 4, 64 }) {
+        auto input = makeInput(megabytes << 20);
+        printHeader("Integer tokens in " + to_string(megabytes) + " MB");
+
+        size_t validTokens = 0;
+        auto countValid = [&tokens, &validTokens]() {
+            validTokens = 0;
+            for (auto& token : tokens) validTokens += token.valid ? 1 : 0;
+        };
+        auto repetitions = megabytes > 4 ? 2 : 10;
+        printResult("token by token isInteger", input.size(), averageMicroseconds(repetitions, [&]() { scanTokenByToken(input, tokens); }));
+        countValid();
+        auto expectedValid = validTokens;
+
+        for (auto [name, path] : { std::pair{ "scanIntegerTokens scalar", ScanPath::Scalar }, { "scanIntegerTokens SSE2", ScanPath::SSE2 }, { "scanIntegerTokens AVX2", ScanPath::AVX2 } }) {
+            printResult(name, input.size(), averageMicroseconds(repetitions, [&]() { scanIntegerTokens(input, tokens, path); }));
+            countValid();
+            if (validTokens != expectedValid) std::puts("unexpected");
+        }
+        std::printf("%zu tokens, %zu valid\n", tokens.size(), validTokens);
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*********************************************************************
+ * @file  benchMenuSearch.cpp
+ *
+ * @brief Lookup time of Menu::findNode on a one million node menu
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "consoleMenu.h"
+
+#include <string>
+#include <vector>
+
+using consoleMenu::PooledMenu;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using std::string;
+using std::to_string;
+using std::vector;
+
+int main() {
+    constexpr unsigned short fanOut = 100;
+    PooledMenu menu{};
+    menu.tree.reserve(size_t{ fanOut } * fanOut * fanOut + fanOut * fanOut + fanOut + 1);
+
+    size_t nodeCount = 0;
+    auto buildTime = averageMicroseconds(1, [&menu, &nodeCount]() {
+        vector<unsigned short> path{};
+        for (unsigned short rack = 0; rack < fanOut; ++rack, ++nodeCount) {
+            menu.addChildNodeAtPath({}, { "Rack " + to_string(rack) });
+        }
+        for (unsigned short rack = 0; rack < fanOut; ++rack) {
+            path = { rack };
+            for (unsigned short host = 0; host < fanOut; ++host, ++nodeCount) {
+                menu.addChildNodeAtPath(path, { "Host node-" + to_string(rack * fanOut + host) });
+            }
+        }
+        for (unsigned short rack = 0; rack < fanOut; ++rack) {
+            for (unsigned short host = 0; host < fanOut; ++host) {
+                path = { rack, host };
+                for (unsigned short job = 0; job < fanOut; ++job, ++nodeCount) {
+                    menu.addChildNodeAtPath(path, { "Job " + to_string((rack * fanOut + host) * fanOut + job) + " on node-" + to_string(rack * fanOut + host) });
+                }
+            }
+        }
+    });
+
+    printHeader("Menu search");
+    printResult("build with index", nodeCount, buildTime);
+    for (auto query : { "Job 987654", "node-4242", "Rack 99", "jo", "no such item" }) {
+        auto searchTime = averageMicroseconds(1000, [&menu, query]() {
+            auto match = menu.findNode(query);
+            if (match && match->empty()) std::puts("unexpected");
+        });
+        printResult(string("findNode \"") + query + "\"", nodeCount, searchTime);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*********************************************************************
+ * @file  benchMenuServer.cpp
+ *
+ * @brief Round trip latency per session of MenuServer with 1, 10 and 100
+ *        concurrent sessions navigating one shared menu
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "menuServer.h"
+
+#include <cstdio>
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <latch>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using consoleMenu::PooledMenu;
+using consoleMenu::PooledMenuServer;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using std::string;
+using std::string_view;
+using std::to_string;
+using std::vector;
+using namespace std::chrono_literals;
+
+static constexpr size_t ROUND_TRIPS = 200;
+
+static int connectToSocket(const string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && 0 != connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads until the received frame ends with prompt
+static bool readUntilPrompt(int fd, string& received, string_view prompt) {
+    received.clear();
+    char chunk[4096];
+    while (!received.ends_with(prompt)) {
+        auto bytesRead = read(fd, chunk, sizeof(chunk));
+        if (bytesRead <= 0) return false;
+        received.append(chunk, static_cast<size_t>(bytesRead));
+    }
+    return true;
+}
+
+// Each client opens a node and goes back again, timing every selection until the next prompt arrives
+static vector<double> runSessions(const string& socketPath, size_t sessionCount, string_view prompt) {
+    vector<double> latencies(sessionCount * ROUND_TRIPS);
+    std::latch connected{ static_cast<std::ptrdiff_t>(sessionCount) };
+    vector<std::thread> clients{};
+    for (size_t session = 0; session < sessionCount; ++session) {
+        clients.emplace_back([&, session]() {
+            int fd = connectToSocket(socketPath);
+            string received{};
+            bool ready = fd >= 0 && readUntilPrompt(fd, received, prompt);
+            connected.arrive_and_wait();
+            if (!ready) return;
+
+            auto child = to_string(session % 100 + 1) + "\n";
+            for (size_t trip = 0; trip < ROUND_TRIPS; ++trip) {
+                string_view selection = 0 == trip % 2 ? string_view{ child } : "b\n";
+                auto start = benchUtils::clock::now();
+                if (write(fd, selection.data(), selection.size()) < 0 || !readUntilPrompt(fd, received, prompt)) break;
+                std::chrono::duration<double, std::micro> elapsed = benchUtils::clock::now() - start;
+                latencies[session * ROUND_TRIPS + trip] = elapsed.count();
+            }
+            if (write(fd, "q\n", 2) < 0) std::puts("unexpected");
+            close(fd);
+        });
+    }
+    for (auto& client : clients) client.join();
+    return latencies;
+}
+
+int main() {
+    constexpr unsigned short fanOut = 100;
+    auto menu = std::make_shared<PooledMenu>();
+    for (unsigned short rack = 0; rack < fanOut; ++rack) {
+        menu->addChildNodeAtPath({}, { "Rack " + to_string(rack) });
+        vector<unsigned short> path{ rack };
+        for (unsigned short host = 0; host < fanOut; ++host) {
+            menu->addChildNodeAtPath(path, { "Host node-" + to_string(rack * fanOut + host) });
+        }
+    }
+    menu->viewport.size = 20;
+    string prompt{ menu->userPrompt() };
+
+    string socketPath = "/tmp/benchMenuServer." + to_string(getpid()) + ".sock";
+    unlink(socketPath.c_str());
+    osUtils::EventLoop loop{};
+    PooledMenuServer server{ menu, loop, socketPath };
+    std::atomic<bool> stopped{ false };
+    std::thread serverThread{ [&loop, &stopped]() {
+        while (!stopped) loop.runOnce(10ms);
+    } };
+
+    printHeader("Menu server round trip per session");
+    for (size_t sessionCount : { 1, 10, 100 }) {
+        auto latencies = runSessions(socketPath, sessionCount, prompt);
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0;
+        for (auto latency : latencies) total += latency;
+        printResult(to_string(sessionCount) + " sessions mean", latencies.size(), total / static_cast<double>(latencies.size()));
+        printResult(to_string(sessionCount) + " sessions p50", latencies.size(), latencies[latencies.size() / 2]);
+        printResult(to_string(sessionCount) + " sessions p99", latencies.size(), latencies[latencies.size() * 99 / 100]);
+    }
+
+    stopped = true;
+    serverThread.join();
+    return 0;
+}
+
+#else
+
+int main() {
+    std::puts("benchMenuServer needs Linux");
+    return 0;
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*********************************************************************
+ * @file  benchMenuStorage.cpp
+ *
+ * @brief Build and render time of Menu (MenuNodeTree) against
+ *        PooledMenu (MenuNodePool) at 10k, 100k and 1M nodes
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "consoleMenu.h"
+
+#include <cmath>
+#include <vector>
+
+using consoleMenu::Menu;
+using consoleMenu::PooledMenu;
+using consoleMenu::MenuContents;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using benchUtils::NullStream;
+using std::vector;
+
+// Builds a three level tree with nodeCount nodes in breadth first order
+template <class MenuType>
+static void buildMenu(MenuType& menu, size_t nodeCount) {
+    auto fanOut = static_cast<unsigned short>(std::ceil(std::cbrt(static_cast<double>(nodeCount))));
+    MenuContents contents{ "Menu item with a short brief", "" };
+    size_t added = 0;
+    vector<unsigned short> path{};
+    for (unsigned short first = 0; first < fanOut && added < nodeCount; ++first, ++added) {
+        menu.addChildNodeAtPath({}, contents);
+    }
+    for (unsigned short first = 0; first < fanOut && added < nodeCount; ++first) {
+        path = { first };
+        for (unsigned short second = 0; second < fanOut && added < nodeCount; ++second, ++added) {
+            menu.addChildNodeAtPath(path, contents);
+        }
+    }
+    for (unsigned short first = 0; first < fanOut && added < nodeCount; ++first) {
+        for (unsigned short second = 0; second < fanOut && added < nodeCount; ++second) {
+            path = { first, second };
+            for (unsigned short third = 0; third < fanOut && added < nodeCount; ++third, ++added) {
+                menu.addChildNodeAtPath(path, contents);
+            }
+        }
+    }
+}
+
+template <class MenuType>
+static void benchMenu(const char* name, size_t nodeCount) {
+    NullStream os{};
+    MenuType* menu = nullptr;
+    auto buildTime = averageMicroseconds(1, [&menu, nodeCount]() {
+        menu = new MenuType{};
+        if constexpr (requires { menu->tree.reserve(nodeCount); }) menu->tree.reserve(nodeCount + 1);
+        buildMenu(*menu, nodeCount);
+    });
+    printResult(std::string(name) + " build", nodeCount, buildTime);
+
+    vector<unsigned short> deepPath{ 0, 0 };
+    auto renderTime = averageMicroseconds(100, [&menu, &os, &deepPath]() {
+        menu->getMenuFromRootPath(os, deepPath);
+    });
+    printResult(std::string(name) + " render", nodeCount, renderTime);
+
+    vector<unsigned short> fromPath{ 0, 0 }, toPath{ 1, 1 };
+    auto changeTime = averageMicroseconds(100, [&menu, &os, &fromPath, &toPath]() {
+        menu->changeMenu(os, fromPath, toPath);
+    });
+    printResult(std::string(name) + " changeMenu", nodeCount, changeTime);
+    delete menu;
+}
+
+int main() {
+    printHeader("Menu tree storage");
+    for (size_t nodeCount : { 10'000, 100'000, 1'000'000 }) {
+        benchMenu<Menu>("MenuNodeTree", nodeCount);
+        benchMenu<PooledMenu>("MenuNodePool", nodeCount);
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*********************************************************************
+ * @file  benchPreLayout.cpp
+ *
+ * @brief Time to pre-lay out every brief of a 90k node menu on 1 to N
+ *        threads, for Menu (MenuNodeTree) and PooledMenu (MenuNodePool),
+ *        and what it saves on the first render of a submenu.
+ *        The first argument, if any, replaces the hardware thread count
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "consoleMenu.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using consoleMenu::Menu;
+using consoleMenu::PooledMenu;
+using consoleMenu::MenuContents;
+using consoleMenu::ThreadPool;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::printResult;
+using benchUtils::NullStream;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+static constexpr unsigned short FAN_OUT = 300;
+
+// Two levels of FAN_OUT nodes whose briefs wrap over three or four lines
+template <class MenuType>
+static unique_ptr<MenuType> buildMenu() {
+    auto menu = std::make_unique<MenuType>();
+    if constexpr (requires { menu->tree.reserve(size_t{}); }) menu->tree.reserve(size_t{ FAN_OUT } * (FAN_OUT + 1) + 1);
+    MenuContents contents{ "Menu item whose brief explains what it does in a sentence long enough to wrap on narrow menus", "" };
+    vector<unsigned short> path{};
+    for (unsigned short first = 0; first < FAN_OUT; ++first) {
+        menu->addChildNodeAtPath({}, contents, { .maxLineLength{ 40 } });
+        path = { first };
+        for (unsigned short second = 0; second < FAN_OUT; ++second) menu->addChildNodeAtPath(path, contents, { .maxLineLength{ 40 } });
+    }
+    return menu;
+}
+
+// Thread counts 1, 2, 4, ... up to and including maxThreads
+static vector<size_t> threadCounts(size_t maxThreads) {
+    vector<size_t> counts{};
+    for (size_t count = 1; count < maxThreads; count *= 2) counts.push_back(count);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+template <class MenuType>
+static void benchMenu(const char* name, size_t maxThreads) {
+    constexpr size_t nodeCount = size_t{ FAN_OUT } * (FAN_OUT + 1);
+    printHeader(string{ "preLayoutBriefs of " } + name);
+    double singleThreadTime = 0;
+    for (auto threadCount : threadCounts(maxThreads)) {
+        auto menu = buildMenu<MenuType>();
+        ThreadPool pool{ threadCount };
+        auto time = averageMicroseconds(1, [&menu, &pool]() { menu->preLayoutBriefs(pool); });
+        if (1 == threadCount) singleThreadTime = time;
+        printResult(std::to_string(threadCount) + " threads", nodeCount, time);
+        std::printf("%-40s %12s %16.2fx\n", "", "", singleThreadTime / time);
+    }
+
+    // First visit of a submenu, with and without the layouts from preLayoutBriefs
+    NullStream os{};
+    vector<unsigned short> path{ FAN_OUT / 2 };
+    auto lazyMenu = buildMenu<MenuType>();
+    printResult("first render, laid out on demand", FAN_OUT, averageMicroseconds(1, [&lazyMenu, &os, &path]() { lazyMenu->getMenuFromRootPath(os, path); }));
+    printResult("repeat render", FAN_OUT, averageMicroseconds(1, [&lazyMenu, &os, &path]() { lazyMenu->getMenuFromRootPath(os, path); }));
+    auto preLaidOutMenu = buildMenu<MenuType>();
+    preLaidOutMenu->preLayoutBriefs();
+    printResult("first render after preLayoutBriefs", FAN_OUT, averageMicroseconds(1, [&preLaidOutMenu, &os, &path]() { preLaidOutMenu->getMenuFromRootPath(os, path); }));
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::thread::hardware_concurrency();
+    maxThreads = std::max<size_t>(maxThreads, 1);
+    benchMenu<Menu>("Menu", maxThreads);
+    benchMenu<PooledMenu>("PooledMenu", maxThreads);
+    return 0;
+}
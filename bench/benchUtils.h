@@ -0,0 +1,62 @@
+#pragma once
+/*********************************************************************
+ * @file  benchUtils.h
+ *
+ * @brief Small timing helpers shared by the benchmark executables
+ *
+ *********************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+
+namespace benchUtils {
+    using std::string_view;
+    using clock = std::chrono::steady_clock;
+}
+
+namespace benchUtils {
+
+    /**
+    * Stream buffer that discards everything written to it
+    */
+    class NullBuffer : public std::streambuf {
+        protected:
+            int overflow(int c) override { return c; }
+            std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+
+    /**
+    * Output stream that discards everything written to it
+    */
+    class NullStream : public std::ostream {
+        public:
+            NullStream() : std::ostream{ &buffer } {}
+        private:
+            NullBuffer buffer{};
+    };
+
+    /**
+    * @brief runs function repetitions times and returns the average duration of one run
+    *
+    * @return average duration of a run in microseconds
+    */
+    template <typename F>
+    double averageMicroseconds(size_t repetitions, F&& function) {
+        auto start = clock::now();
+        for (size_t repetition = 0; repetition < repetitions; ++repetition) function();
+        std::chrono::duration<double, std::micro> elapsed = clock::now() - start;
+        return elapsed.count() / static_cast<double>(repetitions);
+    }
+
+    inline void printResult(string_view name, size_t size, double microseconds) {
+        std::printf("%-40.*s %12zu %16.3f us\n", static_cast<int>(name.size()), name.data(), size, microseconds);
+    }
+
+    inline void printHeader(string_view benchmark) {
+        std::printf("\n%.*s\n%-40s %12s %19s\n",
+            static_cast<int>(benchmark.size()), benchmark.data(), "case", "size", "time");
+    }
+}
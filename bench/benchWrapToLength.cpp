@@ -0,0 +1,169 @@
+/*********************************************************************
+ * @file  benchWrapToLength.cpp
+ *
+ * @brief Time per byte of wrapToLength on prose, unbroken base64 and
+ *        UTF-8 prose from 1 KB to 100 MB, against the previous engine
+ *        which searched the rest of a word for '\n' on every line
+ *********************************************************************/
+
+#include "benchUtils.h"
+#include "svUtils.h"
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+using svUtils::LineOptions;
+using svUtils::splitByDelimiter;
+using svUtils::wrapToLength;
+using benchUtils::averageMicroseconds;
+using benchUtils::printHeader;
+using benchUtils::NullStream;
+using std::ostream;
+using std::ostringstream;
+using std::string;
+using std::string_view;
+
+/**
+* wrapToLength before the single pass engine: every piece of a word is written with its own
+* operator<< and the whole rest of the word is searched for '\n' again for every line
+*/
+static void legacyWrapToLength(ostream& os, string_view lines, const LineOptions& lineOptions) {
+    if (lines.empty()) return;
+
+    auto indent{ lineOptions.indent };
+    auto maxLineLength{ lineOptions.maxLineLength };
+    auto delimiter{ lineOptions.delimiter };
+    if (indent.length() >= maxLineLength) indent = indent.substr(0, maxLineLength - 1);
+    size_t indentLength = indent.length();
+
+    auto addWord = [&indent, &maxLineLength, &indentLength](ostream& os, string_view word, size_t& currentPositionInLine) {
+        string_view lettersToAdd, restOfWord;
+        auto remainingWordLength = word.length();
+        while (remainingWordLength > 0) {
+            auto relativeLineEndPosition = maxLineLength - currentPositionInLine;
+            if (relativeLineEndPosition == 0) {
+                os << '\n' << indent;
+                currentPositionInLine = indentLength;
+                continue;
+            }else if (remainingWordLength <= relativeLineEndPosition) {
+                lettersToAdd = word;
+                restOfWord = {};
+            }else {
+                lettersToAdd = word.substr(0, relativeLineEndPosition);
+                restOfWord = word.substr(relativeLineEndPosition);
+            }
+            auto [lettersBeforeNewLine, lettersAfterNewLine] = splitByDelimiter(word, "\n");
+            if (lettersBeforeNewLine.length() < lettersToAdd.length()) {
+                os << lettersBeforeNewLine << '\n' << indent;
+                currentPositionInLine = indentLength;
+                word = lettersAfterNewLine;
+            }else {
+                os << lettersToAdd;
+                currentPositionInLine += lettersToAdd.length();
+                word = restOfWord;
+            }
+            remainingWordLength = word.length();
+        }
+    };
+
+    size_t currentPositionInLine{ 0 };
+    string_view currentWord{}, restOfLines{ lines };
+    while (restOfLines.length() > 0) {
+        std::tie(currentWord, restOfLines) = splitByDelimiter(restOfLines, delimiter);
+        addWord(os, currentWord, currentPositionInLine);
+        if (currentPositionInLine == indentLength) continue;
+        if (currentPositionInLine == maxLineLength) continue;
+        if (restOfLines.length() == 0) continue;
+        addWord(os, delimiter, currentPositionInLine);
+    }
+}
+
+// Words of 1 to 12 letters with a paragraph break now and then, like menu details
+static string makeProse(size_t size) {
+    std::mt19937 generator{ 3 };
+    string text{};
+    text.reserve(size);
+    while (text.size() < size) {
+        text.append(1 + generator() % 12, static_cast<char>('a' + generator() % 26));
+        text += 0 == generator() % 40 ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+// One word with no delimiter and no newline, like a base64 blob in a log line
+static string makeBase64(size_t size) {
+    constexpr string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::mt19937 generator{ 5 };
+    string text(size, ' ');
+    for (auto& c : text) c = alphabet[generator() % alphabet.size()];
+    return text;
+}
+
+static void printPerByte(const string& name, size_t size, double microseconds) {
+    std::printf("%-40s %12zu %16.3f ns/byte\n", name.c_str(), size, 1000 * microseconds / static_cast<double>(size));
+}
+
+// Prose whose words mix accented letters, CJK ideographs and box drawing, which have to be decoded
+static string makeUtf8Prose(size_t size) {
+    constexpr string_view letters[] = { "a", "e", "\xC3\xA9", "\xE6\xBC\xA2", "\xE2\x94\x80", "n", "t" };
+    std::mt19937 generator{ 9 };
+    string text{};
+    text.reserve(size + 16);
+    while (text.size() < size) {
+        for (auto letter = 1 + generator() % 8; letter > 0; --letter) text += letters[generator() % std::size(letters)];
+        text += 0 == generator() % 40 ? '\n' : ' ';
+    }
+    text.resize(size);
+    return text;
+}
+
+static string sizeName(size_t size) {
+    return size >= (size_t{ 1 } << 20) ? std::to_string(size >> 20) + " MB" : std::to_string(size >> 10) + " KB";
+}
+
+int main() {
+    const LineOptions options{ .indent{ "    " }, .maxLineLength{ 80 } };
+    // The previous engine is quadratic on unbroken text, so it only runs on the smaller inputs
+    constexpr size_t largestLegacySize = size_t{ 1 } << 20;
+
+    struct TextKind {
+        const char* name;
+        string (*makeText)(size_t);
+        bool measuredInBytes; //!< Whether the previous engine, which counted bytes, wraps it the same
+    };
+    for (auto [name, makeText, measuredInBytes] : { TextKind{ "prose", &makeProse, true }, { "base64", &makeBase64, true }, { "UTF-8 prose", &makeUtf8Prose, false } }) {
+        printHeader(string{ "wrapToLength on " } + name);
+        for (size_t size = size_t{ 1 } << 10; size <= (size_t{ 100 } << 20); size *= size < (size_t{ 1 } << 20) ? 32 : 10) {
+            auto text = makeText(size);
+            auto repetitions = size < (size_t{ 1 } << 20) ? 200 : size < (size_t{ 10 } << 20) ? 10 : 1;
+
+            if (measuredInBytes && size <= largestLegacySize) {
+                ostringstream legacyOutput{}, output{};
+                legacyWrapToLength(legacyOutput, text, options);
+                wrapToLength(output, text, options);
+                if (legacyOutput.str() != output.str()) std::puts("unexpected");
+
+                NullStream os{};
+                auto legacyTime = averageMicroseconds(repetitions, [&os, &text, &options]() { legacyWrapToLength(os, text, options); });
+                printPerByte("previous engine " + sizeName(size), size, legacyTime);
+            }
+
+            NullStream os{};
+            auto time = averageMicroseconds(repetitions, [&os, &text, &options]() { wrapToLength(os, text, options); });
+            printPerByte("single pass to ostream " + sizeName(size), size, time);
+
+            string output{};
+            auto stringTime = averageMicroseconds(repetitions, [&output, &text, &options]() {
+                output.clear();
+                wrapToLength(output, text, options);
+            });
+            printPerByte("single pass to string " + sizeName(size), size, stringTime);
+        }
+    }
+    return 0;
+}
@@ -3,6 +3,9 @@
 #include "osUtils.h"
 #include "svUtils.h"
 #include "userInput.h"
+#include "numberParser.h"
+#include "menuSearchIndex.h"
+#include "threadPool.h"
 
 #include <limits>
 #include <algorithm>
@@ -15,9 +18,19 @@
 #include <vector>
 #include <span>
 #include <stack>
+#include <list>
+#include <charconv>
+#include <unordered_map>
 #include <string>
 #include <string_view>
 #include <iostream>
+#include <sstream>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <cerrno>
+    #include <unistd.h>
+#endif
 
 
 namespace consoleMenu{
@@ -25,6 +38,7 @@ namespace consoleMenu{
     using svUtils::wrapToLength;
     using std::numeric_limits;
     using std::mismatch;
+    using std::find_if;
     using std::function;
     using std::bind;
     namespace placeholders = std::placeholders;
@@ -34,19 +48,26 @@ namespace consoleMenu{
     using std::optional;
     using std::make_optional;
     using std::stack;
+    using std::list;
+    using std::to_chars;
+    using std::unordered_map;
     using std::prev;
     using std::tuple;
     using std::vector;
     using std::span;
     using std::unique_ptr;
     using std::make_unique;
+    using std::shared_ptr;
     using std::string;
     using std::to_string;
     using std::stoull;
     using std::string_view;
+    using std::uint32_t;
     using std::istream;
     using std::ostream;
+    using std::ostringstream;
     using std::cout;
+    using std::cin;
     using namespace std::literals::string_view_literals;
 }
 
@@ -105,158 +126,820 @@ namespace consoleMenu {
         return pathString;
     }
 
+    // Appends the decimal digits of number without a temporary string
+    inline string& appendNumber(string& out, size_t number) {
+        char digits[numeric_limits<size_t>::digits10 + 1];
+        auto result = to_chars(digits, digits + sizeof(digits), number);
+        return out.append(digits, result.ptr);
+    }
+
+    inline string bulletString(size_t itemNum, unsigned short spaceAfterBullet) {
+        return to_string(itemNum) + "." + string(spaceAfterBullet, SPACECHARACTER);
+    }
+
+    struct LayoutCacheStats {
+        size_t hits{0};
+        size_t misses{0};
+    };
+
+    /**
+    * A node's brief as MenuContents::addItem writes it, together with the layout it was wrapped for
+    */
+    struct BriefLayoutCache {
+        struct Key {
+            size_t itemNum{0};
+            unsigned short spaceAfterBullet{0};
+            unsigned short indentSpaces{0};
+            unsigned short maxLineLength{0};
+            bool operator==(const Key& other) const = default;
+        };
+
+        Key key{};
+        bool valid{false};
+        string text{};
+
+        inline void invalidate() { valid = false; }
+
+        const string& layout(string_view brief, const Key& layoutKey, LayoutCacheStats& stats) {
+            if (valid && key == layoutKey) {
+                ++stats.hits;
+                return text;
+            }
+            ++stats.misses;
+            ostringstream laidOut{};
+            MenuContents::addItem(
+                laidOut,
+                brief,
+                layoutKey.indentSpaces,
+                layoutKey.maxLineLength,
+                bulletString(layoutKey.itemNum, layoutKey.spaceAfterBullet)
+            );
+            text = std::move(laidOut).str();
+            key = layoutKey;
+            valid = true;
+            return text;
+        }
+    };
+
+    /**
+    * Page of children rendered for each level of the menu when paging is enabled
+    */
+    struct Viewport {
+        size_t size{0};  //!< Children rendered per level; 0 renders every child
+        size_t start{0}; //!< Index of the first child rendered for the last node on the path
+
+        // Page aligned range [first, last) of children which contains index
+        tuple<size_t, size_t> window(size_t childCount, size_t index) const {
+            if (0 == size) return { 0, childCount };
+            auto first = index - index % size;
+            return { first, std::min(first + size, childCount) };
+        }
+
+        static string& appendPageIndicator(string& frame, size_t first, size_t last, size_t childCount) {
+            if (last - first == childCount) return frame;
+            frame += "\n[";
+            appendNumber(frame, first + 1) += '-';
+            appendNumber(frame, last) += " of ";
+            return appendNumber(frame, childCount) += ']';
+        }
+    };
+
+    struct MenuItem {
+        MenuContents contents{};
+        MenuSettings settings{};
+    };
+
+    // Produces the children of a node the first time the node is expanded
+    using ChildProvider = function<vector<MenuItem>()>;
+
+    static constexpr char TOO_MANY_CHILDREN_ERROR[] =
+        "Cannot add child node because maximum number of children was reached for parent node";
+
     class MenuNode {
     public:
         using nodePtrsVector = vector<unique_ptr<MenuNode>>;
-        MenuContents contents;
         MenuSettings settings;
         nodePtrsVector children{};
+        mutable BriefLayoutCache briefLayout{};
+        ChildProvider childProvider{};
+        bool childrenProvided{ false };
 
         MenuNode(
             const MenuContents& contents,
             const MenuSettings& settings,
             nodePtrsVector& children
         ) :
-            contents{ contents },
             settings{ settings },
-            children{ std::move(children) }
+            children{ std::move(children) },
+            menuContents{ contents }
         {};
 
         MenuNode(
             const MenuContents& contents,
             const MenuSettings& settings
         ) :
-            contents{ contents },
-            settings{ settings }
-
+            settings{ settings },
+            menuContents{ contents }
         {};
 
         inline void hide() { settings.hidden = true; }
         inline void unhide() { settings.hidden = false; }
 
-        void hideDirectDescendants() {
-            for (auto& node : children) {
-                node->hide();
-            }
-        }
+        inline void invalidateLayout() { briefLayout.invalidate(); }
 
-        void unhideDirectDescendants() {
-            for (auto& node : children) {
-                node->unhide();
-            }
+        inline bool isLazy() const { return static_cast<bool>(childProvider); }
+
+        // Adds the children from childProvider unless they are already there
+        bool expand() {
+            if (!isLazy() || childrenProvided) return false;
+            auto items = childProvider();
+            if (children.size() + items.size() > numeric_limits<unsigned short>::max()) throw TOO_MANY_CHILDREN_ERROR;
+            for (const auto& item : items) children.emplace_back(make_unique<MenuNode>(item.contents, item.settings));
+            childrenProvided = true;
+            return true;
         }
 
-        void hideAllDescendants() {
-            for (auto& node : children) {
-                node->hide();
-                node->hideAllDescendants();
-            }
+        // Drops the children from childProvider; they are provided again on the next expand
+        void collapse() {
+            if (!isLazy()) return;
+            children.clear();
+            childrenProvided = false;
         }
 
-        void unhideAllDescendants() {
-            for (auto& node : children) {
-                node->hide();
-                node->unhideAllDescendants();
-            }
+        const MenuContents& contents() const { return menuContents; }
+
+        // The only way to change the contents, so the laid out brief never goes stale
+        void setContents(const MenuContents& newContents) {
+            menuContents = newContents;
+            invalidateLayout();
         }
 
+        void setSettings(const MenuSettings& newSettings) {
+            settings = newSettings;
+            invalidateLayout();
+        }
 
         using optionalNodeRef = optional<reference_wrapper<MenuNode>>;
         using nodePtr = unique_ptr<MenuNode>;
 
         optionalNodeRef nodeAtRelativePath(span<const unsigned short> relativePath) {
-            MenuNode& node = *this;
-            if (relativePath.empty()) return { node }; // Return this node if relativePath is empty
+            reference_wrapper<MenuNode> node = *this; // This node if relativePath is empty
             for (const auto& index : relativePath) {
-                if (index < node.children.size()) {
-                    if (!node.children.at(index)) return {}; // Check for null pointer
-                    auto remainingPathLength = relativePath.size() - 1;
-                    if (0 == remainingPathLength) return { *(node.children.at(index)) };
-                    return node.nodeAtRelativePath(relativePath.last(remainingPathLength));
-                }else {
-                    return {};
-                }
+                if (index >= node.get().children.size()) return {};
+                if (!node.get().children.at(index)) return {}; // Check for null pointer
+                node = *(node.get().children.at(index));
             }
-            return {};
+            return { node };
         }
 
-       bool isValidPath(span<const unsigned short> path){
-           reference_wrapper<MenuNode> currentNode = *this;
-            for (const auto& nodeIndex : path) {
-                if(path[0] < currentNode.get().children.size()){
-                    currentNode = *(currentNode.get().children.at(path[0]));
-                    path = path.last(path.size() - 1);
-                } else {
-                    return false;
-                }
-            }
-            return true;
-        }
+        ostream& addBriefs(
+            ostream& os,
+            LayoutCacheStats& stats
+        ) const {
+            size_t itemNum = 1;
+            for (const auto& node : children) {
+                BriefLayoutCache::Key layoutKey{
+                    .itemNum{ itemNum++ },
+                    .spaceAfterBullet{ settings.spaceAfterBullet },
+                    .indentSpaces{ node->settings.briefIndentSpaces },
+                    .maxLineLength{ node->settings.maxLineLength }
+                };
 
-        void unhideToPath(span<const unsigned short> path) {
-            this->unhideDirectDescendants();
-            if  (0 == path.size()) return;
-            if (path[0] < children.size()) {
-                children.at(path[0])->unhideToPath(path.last(path.size() - 1));
-            }else {
-                throw "Unable to access menu node at path " + pathString(path);
+                if (!node->settings.hidden) {
+                    os << node->briefLayout.layout(node->contents().brief, layoutKey, stats);
+                    node->addBriefs(os, stats);
+                }
             }
+            return os;
         }
 
         ostream& addBriefs(
             ostream& os
         ) const {
-            int itemNum = 1;
-            for (const auto& node : children) {
-                auto bulletString =
-                    to_string(itemNum++)
-                    + "."
-                    + string(settings.spaceAfterBullet, SPACECHARACTER);
+            LayoutCacheStats stats{};
+            return addBriefs(os, stats);
+        }
 
-                if (!node->settings.hidden) {
-                    MenuContents::addItem(
-                        os,
-                        node->contents.brief,
-                        node->settings.briefIndentSpaces,
-                        node->settings.maxLineLength,
-                        bulletString
-                    );
-                    node->addBriefs(os);
-                }
+        // Renders the children of every node on path, limited to the page of the viewport at each level
+        string& appendBriefsAlongPath(
+            string& frame,
+            span<const unsigned short> path,
+            const Viewport& viewport,
+            LayoutCacheStats& stats
+        ) const {
+            auto [first, last] = viewport.window(children.size(), path.empty() ? viewport.start : path[0]);
+            for (auto index = first; index < last; ++index) {
+                const auto& node = children[index];
+                if (node->settings.hidden) continue;
+                BriefLayoutCache::Key layoutKey{
+                    .itemNum{ index + 1 },
+                    .spaceAfterBullet{ settings.spaceAfterBullet },
+                    .indentSpaces{ node->settings.briefIndentSpaces },
+                    .maxLineLength{ node->settings.maxLineLength }
+                };
+                frame += node->briefLayout.layout(node->contents().brief, layoutKey, stats);
+                if (!path.empty() && index == path[0]) node->appendBriefsAlongPath(frame, path.subspan(1), viewport, stats);
             }
-            return os;
+            return Viewport::appendPageIndicator(frame, first, last, children.size());
         }
 
+    private:
+        MenuContents menuContents;
+    };
+
+    enum class RenderMode {
+        Full,       //!< Clear the screen and print every frame in full
+        Incremental //!< On terminals, rewrite only the lines that changed since the previous frame
+    };
+
+    static constexpr MenuSettings ROOT_SETTINGS{
+        .spaceAfterBullet{1},
+        .briefIndentSpaces{0},
+        .detailsIndentSpaces{0},
+        .maxLineLength{DEFAULT_MAX_LINE_LENGTH},
+        .hidden{true}
     };
 
-    class Menu {
+    /**
+    * Tree storage where every node is an individually allocated MenuNode
+    */
+    class MenuNodeTree {
+        public:
+            using NodeRef = reference_wrapper<MenuNode>;
+            using optionalNodeRef = optional<NodeRef>;
+
+            MenuNode root{ MenuContents{{},{}}, ROOT_SETTINGS };
+
+            NodeRef rootNode() { return root; }
+
+            size_t childCount(NodeRef node) const { return node.get().children.size(); }
+
+            const MenuContents& contents(NodeRef node) const { return node.get().contents(); }
 
+            // The node's current children are replaced by the ones from provider
+            void setChildProvider(NodeRef node, ChildProvider provider) {
+                node.get().children.clear();
+                node.get().childProvider = std::move(provider);
+                node.get().childrenProvided = false;
+            }
+
+            bool expand(NodeRef node) { return node.get().expand(); }
+            bool isExpandable(NodeRef node) const { return node.get().isLazy() && !node.get().childrenProvided; }
+            void collapse(NodeRef node) { node.get().collapse(); }
+
+            optionalNodeRef childAt(NodeRef node, size_t index) const {
+                auto& children = node.get().children;
+                if (index >= children.size() || !children[index]) return {};
+                return { *children[index] };
+            }
+
+            template <typename F>
+            void forEachChild(NodeRef node, F&& f) const {
+                for (auto& child : node.get().children) f(*child);
+            }
+
+            optionalNodeRef nodeAtRelativePath(NodeRef node, span<const unsigned short> relativePath) {
+                return node.get().nodeAtRelativePath(relativePath);
+            }
+
+            string& appendBriefsAlongPath(
+                string& frame,
+                NodeRef node,
+                span<const unsigned short> path,
+                const Viewport& viewport
+            ) const {
+                return node.get().appendBriefsAlongPath(frame, path, viewport, layoutCacheStats);
+            }
+
+            // Lays out the brief of every node for its current position, across the threads of pool
+            void preLayoutBriefs(ThreadPool& pool) const {
+                vector<tuple<const MenuNode*, BriefLayoutCache::Key>> layouts{};
+                vector<const MenuNode*> parents{ &root };
+                while (!parents.empty()) {
+                    auto parent = parents.back();
+                    parents.pop_back();
+                    for (size_t index = 0; index < parent->children.size(); ++index) {
+                        const auto& node = parent->children[index];
+                        layouts.push_back({ node.get(), {
+                            .itemNum{ index + 1 },
+                            .spaceAfterBullet{ parent->settings.spaceAfterBullet },
+                            .indentSpaces{ node->settings.briefIndentSpaces },
+                            .maxLineLength{ node->settings.maxLineLength }
+                        } });
+                        parents.push_back(node.get());
+                    }
+                }
+                pool.forEachIndex(layouts.size(), [&layouts](size_t layout) {
+                    auto [node, layoutKey] = layouts[layout];
+                    LayoutCacheStats uncounted{};
+                    node->briefLayout.layout(node->contents().brief, layoutKey, uncounted);
+                });
+            }
+
+            mutable LayoutCacheStats layoutCacheStats{};
+
+            optionalNodeRef addChild(
+                NodeRef parent,
+                const MenuContents& contents,
+                const MenuSettings& settings
+            ) {
+                auto& children = parent.get().children;
+                children.emplace_back(make_unique<MenuNode>(contents, settings));
+                if (!children.back()) return {};
+                return { *(children.back()) };
+            }
+    };
+
+    /**
+    * Tree storage where all nodes live in one contiguous pool addressed by 32 bit ids.
+    * Fields touched by every render (hidden flag and links) are kept in separate
+    * arrays from the node contents and layout settings.
+    */
+    class MenuNodePool {
         public:
+            using NodeId = uint32_t;
+            using NodeRef = NodeId;
+            using optionalNodeRef = optional<NodeRef>;
+
+            static constexpr NodeId NO_NODE = numeric_limits<NodeId>::max();
+            static constexpr NodeId ROOT_NODE = 0;
+
+            MenuNodePool() {
+                appendNode(MenuContents{{},{}}, ROOT_SETTINGS);
+            }
+
+            void reserve(size_t nodeCount) {
+                nodeContents.reserve(nodeCount);
+                nodeSettings.reserve(nodeCount);
+                briefLayouts.reserve(nodeCount);
+                hiddenFlags.reserve(nodeCount);
+                firstChildren.reserve(nodeCount);
+                lastChildren.reserve(nodeCount);
+                nextSiblings.reserve(nodeCount);
+                childCounts.reserve(nodeCount);
+                consecutiveChildren.reserve(nodeCount);
+            }
+
+            size_t size() const { return nodeContents.size(); }
+
+            NodeRef rootNode() const { return ROOT_NODE; }
+
+            const MenuContents& contents(NodeId node) const { return nodeContents[node]; }
+
+            void setContents(NodeId node, const MenuContents& contents) {
+                nodeContents[node] = contents;
+                briefLayouts[node].invalidate();
+            }
+
+            void setSettings(NodeId node, const MenuSettings& settings) {
+                nodeSettings[node] = settings;
+                hiddenFlags[node] = settings.hidden ? 1 : 0;
+                briefLayouts[node].invalidate();
+            }
+
+            MenuSettings settings(NodeId node) const {
+                auto nodeSetting = nodeSettings[node];
+                nodeSetting.hidden = isHidden(node);
+                return nodeSetting;
+            }
+
+            inline bool isHidden(NodeId node) const { return hiddenFlags[node] != 0; }
+            inline void hide(NodeId node) { hiddenFlags[node] = 1; }
+            inline void unhide(NodeId node) { hiddenFlags[node] = 0; }
+
+            inline NodeId firstChild(NodeId node) const { return firstChildren[node]; }
+            inline NodeId nextSibling(NodeId node) const { return nextSiblings[node]; }
+            inline size_t childCount(NodeId node) const { return childCounts[node]; }
+
+            template <typename F>
+            void forEachChild(NodeId node, F&& f) const {
+                for (auto child = firstChildren[node]; child != NO_NODE; child = nextSiblings[child]) f(child);
+            }
+
+            // The node's current children are replaced by the ones from provider
+            void setChildProvider(NodeId node, ChildProvider provider) {
+                releaseChildren(node);
+                lazyChildren[node] = { std::move(provider), false };
+            }
+
+            // Whether expand would add children from a provider
+            bool isExpandable(NodeId node) const {
+                auto lazy = lazyChildren.find(node);
+                return lazy != lazyChildren.end() && !lazy->second.provided;
+            }
+
+            bool expand(NodeId node) {
+                auto lazy = lazyChildren.find(node);
+                if (lazy == lazyChildren.end() || lazy->second.provided) return false;
+                auto items = lazy->second.provider();
+                if (childCounts[node] + items.size() > numeric_limits<unsigned short>::max()) throw TOO_MANY_CHILDREN_ERROR;
+                for (const auto& item : items) addChild(node, item.contents, item.settings);
+                lazyChildren[node].provided = true;
+                return true;
+            }
+
+            // Returns the children from the node's provider, and everything below them, to the pool
+            void collapse(NodeId node) {
+                auto lazy = lazyChildren.find(node);
+                if (lazy == lazyChildren.end() || !lazy->second.provided) return;
+                lazy->second.provided = false;
+                releaseChildren(node);
+            }
+
+            optionalNodeRef childAt(NodeId node, size_t index) const {
+                if (index >= childCounts[node]) return {};
+                auto child = firstChildren[node];
+                if (consecutiveChildren[node]) return { child + static_cast<NodeId>(index) };
+                while (index-- > 0) child = nextSiblings[child];
+                return { child };
+            }
+
+            optionalNodeRef nodeAtRelativePath(NodeId node, span<const unsigned short> relativePath) const {
+                for (const auto& index : relativePath) {
+                    auto maybeChild = childAt(node, index);
+                    if (!maybeChild) return {};
+                    node = maybeChild.value();
+                }
+                return { node };
+            }
+
+            string& appendBriefsAlongPath(
+                string& frame,
+                NodeId node,
+                span<const unsigned short> path,
+                const Viewport& viewport
+            ) const {
+                auto childCount = childCounts[node];
+                auto [first, last] = viewport.window(childCount, path.empty() ? viewport.start : path[0]);
+                auto spaceAfterBullet = nodeSettings[node].spaceAfterBullet;
+                auto child = childAt(node, first).value_or(NO_NODE);
+                for (auto index = first; index < last; ++index, child = nextSiblings[child]) {
+                    if (isHidden(child)) continue;
+                    BriefLayoutCache::Key layoutKey{
+                        .itemNum{ index + 1 },
+                        .spaceAfterBullet{ spaceAfterBullet },
+                        .indentSpaces{ nodeSettings[child].briefIndentSpaces },
+                        .maxLineLength{ nodeSettings[child].maxLineLength }
+                    };
+                    frame += briefLayouts[child].layout(nodeContents[child].brief, layoutKey, layoutCacheStats);
+                    if (!path.empty() && index == path[0]) appendBriefsAlongPath(frame, child, path.subspan(1), viewport);
+                }
+                return Viewport::appendPageIndicator(frame, first, last, childCount);
+            }
+
+            // Lays out the brief of every node reachable from the root for its current position, across the threads of pool
+            void preLayoutBriefs(ThreadPool& pool) const {
+                vector<tuple<NodeId, BriefLayoutCache::Key>> layouts{};
+                layouts.reserve(size());
+                vector<NodeId> parents{ ROOT_NODE };
+                while (!parents.empty()) {
+                    auto parent = parents.back();
+                    parents.pop_back();
+                    size_t itemNum = 0;
+                    forEachChild(parent, [this, parent, &itemNum, &layouts, &parents](NodeId child) {
+                        layouts.push_back({ child, {
+                            .itemNum{ ++itemNum },
+                            .spaceAfterBullet{ nodeSettings[parent].spaceAfterBullet },
+                            .indentSpaces{ nodeSettings[child].briefIndentSpaces },
+                            .maxLineLength{ nodeSettings[child].maxLineLength }
+                        } });
+                        parents.push_back(child);
+                    });
+                }
+                pool.forEachIndex(layouts.size(), [this, &layouts](size_t layout) {
+                    auto [node, layoutKey] = layouts[layout];
+                    LayoutCacheStats uncounted{};
+                    briefLayouts[node].layout(nodeContents[node].brief, layoutKey, uncounted);
+                });
+            }
+
+            optionalNodeRef addChild(
+                NodeId parent,
+                const MenuContents& contents,
+                const MenuSettings& settings
+            ) {
+                if (parent >= size()) return {};
+                auto child = appendNode(contents, settings);
+                if (NO_NODE == firstChildren[parent]) {
+                    firstChildren[parent] = child;
+                    consecutiveChildren[parent] = 1;
+                } else {
+                    nextSiblings[lastChildren[parent]] = child;
+                    if (child != lastChildren[parent] + 1) consecutiveChildren[parent] = 0;
+                }
+                lastChildren[parent] = child;
+                ++childCounts[parent];
+                return { child };
+            }
+
+            mutable LayoutCacheStats layoutCacheStats{};
+
+        private:
+            // Cold data: only read when a node is rendered
+            vector<MenuContents> nodeContents{};
+            vector<MenuSettings> nodeSettings{};
+            mutable vector<BriefLayoutCache> briefLayouts{};
+
+            // Hot data: read on every render
+            vector<unsigned char> hiddenFlags{};
+            vector<NodeId> firstChildren{};
+            vector<NodeId> lastChildren{};
+            vector<NodeId> nextSiblings{};
+            vector<unsigned short> childCounts{};
+            vector<unsigned char> consecutiveChildren{}; // Children have ids first, first + 1, ... so childAt is O(1)
+
+            struct LazyChildren {
+                ChildProvider provider{};
+                bool provided{ false };
+            };
+            unordered_map<NodeId, LazyChildren> lazyChildren{}; // Only the few nodes with a child provider
+            vector<NodeId> freeNodes{};                          // Slots released by collapse
+
+            // Returns every node below node to the pool
+            void releaseChildren(NodeId node) {
+                vector<NodeId> releaseStack{};
+                forEachChild(node, [&releaseStack](NodeId child) { releaseStack.push_back(child); });
+                while (!releaseStack.empty()) {
+                    auto released = releaseStack.back();
+                    releaseStack.pop_back();
+                    forEachChild(released, [&releaseStack](NodeId child) { releaseStack.push_back(child); });
+                    nodeContents[released] = {};
+                    briefLayouts[released] = {};
+                    lazyChildren.erase(released);
+                    freeNodes.push_back(released);
+                }
+                firstChildren[node] = NO_NODE;
+                lastChildren[node] = NO_NODE;
+                childCounts[node] = 0;
+                consecutiveChildren[node] = 1;
+            }
+
+            NodeId appendNode(const MenuContents& contents, const MenuSettings& settings) {
+                if (!freeNodes.empty()) {
+                    auto node = freeNodes.back();
+                    freeNodes.pop_back();
+                    nodeContents[node] = contents;
+                    nodeSettings[node] = settings;
+                    hiddenFlags[node] = settings.hidden ? 1 : 0;
+                    firstChildren[node] = NO_NODE;
+                    lastChildren[node] = NO_NODE;
+                    nextSiblings[node] = NO_NODE;
+                    childCounts[node] = 0;
+                    consecutiveChildren[node] = 1;
+                    return node;
+                }
+                if (size() >= NO_NODE) throw "Cannot add node because the menu node pool is full";
+                auto node = static_cast<NodeId>(size());
+                nodeContents.push_back(contents);
+                nodeSettings.push_back(settings);
+                briefLayouts.emplace_back();
+                hiddenFlags.push_back(settings.hidden ? 1 : 0);
+                firstChildren.push_back(NO_NODE);
+                lastChildren.push_back(NO_NODE);
+                nextSiblings.push_back(NO_NODE);
+                childCounts.push_back(0);
+                consecutiveChildren.push_back(1);
+                return node;
+            }
+    };
+
+    /**
+    * Read only view of a tree storage owned by another menu, so that many menus can navigate
+    * one tree at once while each keeps its own path and render state.
+    * Nodes can not be added and child providers are not expanded through the view.
+    * Rendering still fills the layout caches of the shared tree, so every menu on it
+    * has to run on the owner's thread.
+    */
+    template <class Tree>
+    class SharedMenuTree {
+        public:
+            using NodeRef = typename Tree::NodeRef;
+            using optionalNodeRef = typename Tree::optionalNodeRef;
+
+            SharedMenuTree(shared_ptr<Tree> sharedTree, shared_ptr<const MenuSearchIndex> sharedSearchIndex) :
+                layoutCacheStats{ sharedTree->layoutCacheStats },
+                sharedTree{ std::move(sharedTree) },
+                sharedSearchIndex{ std::move(sharedSearchIndex) } {}
+
+            NodeRef rootNode() const { return sharedTree->rootNode(); }
+
+            size_t childCount(NodeRef node) const { return sharedTree->childCount(node); }
+
+            const MenuContents& contents(NodeRef node) const { return sharedTree->contents(node); }
+
+            // Children from a provider would change the tree under every other menu
+            bool expand(NodeRef) { return false; }
+            bool isExpandable(NodeRef) const { return false; }
+            void collapse(NodeRef) {}
+
+            optionalNodeRef childAt(NodeRef node, size_t index) const { return sharedTree->childAt(node, index); }
+
+            template <typename F>
+            void forEachChild(NodeRef node, F&& f) const { sharedTree->forEachChild(node, std::forward<F>(f)); }
+
+            optionalNodeRef nodeAtRelativePath(NodeRef node, span<const unsigned short> relativePath) const {
+                return sharedTree->nodeAtRelativePath(node, relativePath);
+            }
+
+            string& appendBriefsAlongPath(
+                string& frame,
+                NodeRef node,
+                span<const unsigned short> path,
+                const Viewport& viewport
+            ) const {
+                return sharedTree->appendBriefsAlongPath(frame, node, path, viewport);
+            }
+
+            // Index of the owner's tree; BasicMenu::findNode searches it instead of its own
+            const MenuSearchIndex& searchIndex() const { return *sharedSearchIndex; }
+
+            LayoutCacheStats& layoutCacheStats; // Shared with the owner
+
+        private:
+            shared_ptr<Tree> sharedTree;
+            shared_ptr<const MenuSearchIndex> sharedSearchIndex;
+    };
+
+    // What applying a user option did
+    enum class OptionOutcome {
+        Moved,         //!< The path or the page changed
+        Quit,
+        AtTopLevel,    //!< 'b' at the root
+        NoMorePages,   //!< 'n' or 'p' past the first or last page
+        NoSearchMatch, //!< No brief matches the search query
+        InvalidOption, //!< Not an option, or not one of the current node
+        Highlighted    //!< Only the option highlighted for keystroke input changed
+    };
+
+    // Keystroke input typed so far by BasicMenu::handleKey
+    struct KeyInput {
+        size_t highlight{0}; //!< 0 based index of the child Enter or Right selects
+        string typed{};      //!< Digits of an option number, or '/' and a search query
+    };
+
+    enum class BatchRecord {
+        None,       //!< Nothing is written
+        FinalState, //!< One line with the step count, invalid selection count and final path
+        PerStep     //!< A line with the step, selection, outcome and path after every selection, then the final line
+    };
+
+    struct InvalidSelection {
+        size_t step{0}; //!< 1 based position of the selection in the input
+        string selection{};
+        OptionOutcome outcome{ OptionOutcome::InvalidOption };
+    };
+
+    struct BatchResult {
+        vector<unsigned short> finalPath{};
+        size_t steps{0};
+        vector<InvalidSelection> invalidSelections{};
+    };
+
+    /**
+    * Menu navigation and display on top of a tree storage (MenuNodeTree or MenuNodePool)
+    */
+    template <class Tree>
+    class BasicMenu {
+
+        public:
+            using NodeRef = typename Tree::NodeRef;
+            using optionalNodeRef = typename Tree::optionalNodeRef;
+
+            BasicMenu() = default;
+            // A tree which already has nodes is indexed on the first search
+            explicit BasicMenu(Tree tree) : tree{ std::move(tree) }, searchIndexStale{ true } {}
 
             vector<unsigned short> currentMenuPath = {}; // Current Node Path from Root
-            MenuNode root{
-                std::move(MenuContents{{},{}}),
-                std::move(
-                    MenuSettings {
-                            .spaceAfterBullet{1},
-                            .briefIndentSpaces{0},
-                            .detailsIndentSpaces{0},
-                            .maxLineLength{DEFAULT_MAX_LINE_LENGTH},
-                            .hidden{true}
-                        }
-                    )
-                };
+            Tree tree{};
+            stack<NodeRef, vector<NodeRef>> cursor{};    // Nodes from the root to the node at currentMenuPath
+            RenderMode renderMode{ RenderMode::Full };
+            osUtils::ClearMethod clearMethod{ osUtils::ClearMethod::EscapeSequence };
+            Viewport viewport{}; // Set viewport.size to page menus with many children
+            MenuSearchIndex searchIndex{}; // addChildNodeAtPath indexes nodes; children from providers are not
+            size_t lazyChildBudget{0};      // Most children kept from child providers; 0 keeps all of them
+            string frameBuffer{};                // Reused by every render so steady state rendering does not allocate
+            KeyInput keyInput{};
 
+            const LayoutCacheStats& layoutCacheStats() const { return tree.layoutCacheStats; }
+            void resetLayoutCacheStats() { tree.layoutCacheStats = {}; }
 
+            // Root node of a Menu, which was a member of Menu before it moved into MenuNodeTree
+            MenuNode& root() requires requires(Tree& tree) { tree.root; } { return tree.root; }
+            const MenuNode& root() const requires requires(const Tree& tree) { tree.root; } { return tree.root; }
+
+            /**
+            * @brief lays out the brief of every node in the tree across the threads of pool
+            *
+            * Call it once the tree is built: renders then reuse these layouts until a node's brief,
+            * settings or position change, so the first visit of a submenu costs what a repeat visit does.
+            * Children of child providers are laid out when they are expanded. Not counted in layoutCacheStats.
+            * Trees which lay out as they publish (SnapshotMenuTree) and shared views do not have it.
+            */
+            void preLayoutBriefs(ThreadPool& pool) requires requires(const Tree& tree) { tree.preLayoutBriefs(pool); } {
+                tree.preLayoutBriefs(pool);
+            }
+
+            void preLayoutBriefs(size_t threadCount = thread::hardware_concurrency())
+                requires requires(const Tree& tree, ThreadPool& pool) { tree.preLayoutBriefs(pool); } {
+                ThreadPool pool{ threadCount };
+                preLayoutBriefs(pool);
+            }
+
+            // Resolves currentMenuPath from the root; falls back to the root if the path is no longer valid
+            void resetCursor() {
+                clearCursor();
+                cursor.push(tree.rootNode());
+                expandLazyNode(tree.rootNode(), {});
+                for (size_t level = 0; level < currentMenuPath.size(); ++level) {
+                    auto child = tree.childAt(cursor.top(), currentMenuPath[level]);
+                    if (!child) {
+                        currentMenuPath.clear();
+                        clearCursor();
+                        cursor.push(tree.rootNode());
+                        return;
+                    }
+                    cursor.push(child.value());
+                    expandLazyNode(child.value(), span<const unsigned short>{ currentMenuPath }.first(level + 1));
+                }
+            }
+
+            void setChildProvider(span<const unsigned short> path, ChildProvider provider) {
+                auto node = tree.nodeAtRelativePath(tree.rootNode(), path);
+                if (!node) throw "Unable to access menu node at path " + pathString(path);
+                forgetExpandedBelow(path);
+                tree.setChildProvider(node.value(), std::move(provider));
+            }
+
+            // Materializes the children of a lazy node and evicts the least recently used ones over budget
+            void expandLazyNode(NodeRef node, span<const unsigned short> path) {
+                auto expanded = find_if(expandedLazyNodes.begin(), expandedLazyNodes.end(),
+                    [path](const ExpandedLazyNode& lazyNode) { return std::ranges::equal(lazyNode.path, path); });
+                if (expanded != expandedLazyNodes.end()) {
+                    expandedLazyNodes.splice(expandedLazyNodes.begin(), expandedLazyNodes, expanded);
+                    return;
+                }
+                if (!tree.expand(node)) return;
+
+                auto childCount = tree.childCount(node);
+                expandedLazyNodes.push_front({ { path.begin(), path.end() }, childCount });
+                lazyChildCount += childCount;
+                evictLazyNodes();
+            }
+
+            size_t lazyChildrenInMemory() const { return lazyChildCount; }
+
+            // Moves to the latest version of a versioned tree (SnapshotMenuTree); the path is kept while it exists
+            bool refreshTree() {
+                if constexpr (requires { tree.refresh(); }) {
+                    if (!tree.refresh()) return false;
+                    searchIndexStale = true;
+                    resetCursor();
+                    return true;
+                }
+                return false;
+            }
+
+            NodeRef currentNode() {
+                if (cursor.size() != currentMenuPath.size() + 1) resetCursor();
+                return cursor.top();
+            }
+
+            bool selectChild(unsigned short index) {
+                auto child = tree.childAt(currentNode(), index);
+                if (!child) return false;
+                cursor.push(child.value());
+                currentMenuPath.push_back(index);
+                expandLazyNode(child.value(), currentMenuPath);
+                return true;
+            }
+
+            bool goBack() {
+                if (currentMenuPath.empty()) return false;
+                currentNode();
+                cursor.pop();
+                currentMenuPath.pop_back();
+                return true;
+            }
+
+            void navigateTo(span<const unsigned short> path) {
+                currentMenuPath.assign(path.begin(), path.end());
+                resetCursor();
+            }
+
+            // Renders the children of every node on path; only nodes hidden by the user are left out
             ostream& getMenuFromRootPath(
                 ostream& os, 
                 span<const unsigned short> path
             ) {
-                root.hideAllDescendants();
-                root.unhideToPath(path);
-                root.addBriefs(os);
-                //os << '\n' << userPrompt();
-                return os;
+                auto frame = renderFrame(path);
+                return os.write(frame.data(), frame.size());
+            }
+
+            // Lays the frame for path out in frameBuffer; the view is valid until the next render
+            string_view renderFrame(span<const unsigned short> path) {
+                frameBuffer.clear();
+                tree.appendBriefsAlongPath(frameBuffer, tree.rootNode(), path, viewport);
+                return frameBuffer;
             }
             
             struct RelativePath {
@@ -315,50 +998,76 @@ namespace consoleMenu {
                 span<const unsigned short> currentPath,
                 span<const unsigned short> finalPath
             ) {
-                // Find and Verify Common Node and Final Node
+                // Verify Final Node
                 auto [commonNodePath, remainingPath] = calculateRelativePath(currentPath, finalPath);
-                auto maybeCommonNode = root.nodeAtRelativePath(commonNodePath);
+                auto maybeCommonNode = tree.nodeAtRelativePath(tree.rootNode(), commonNodePath);
                 if (!maybeCommonNode) return os;
-                auto& commonNode = maybeCommonNode.value().get();
                 
-                auto maybeFinalNode = commonNode.nodeAtRelativePath(remainingPath);
+                auto maybeFinalNode = tree.nodeAtRelativePath(maybeCommonNode.value(), remainingPath);
                 if (!maybeFinalNode) return os;
-                auto& finalNode = maybeFinalNode.value().get();
 
-                commonNode.hideAllDescendants();
-                commonNode.unhideToPath(remainingPath);
-                root.addBriefs(os);
-                //os << '\n' << userPrompt();
-                return os;
+                return getMenuFromRootPath(os, finalPath);
             }
 
-            using optionalNodeRef = optional<reference_wrapper<MenuNode>>;
             optionalNodeRef addChildNodeAtPath(
                 span<const unsigned short> path,
                 const MenuContents& contents,
                 const MenuSettings& settings = MenuSettings{}
             ) {
-                auto maybeNode = root.nodeAtRelativePath(path);
+                auto maybeNode = tree.nodeAtRelativePath(tree.rootNode(), path);
                 if (!maybeNode) return {};
-                auto& node = maybeNode.value().get();
+                auto node = maybeNode.value();
                 
                 // Check if the size has reached maxximum
-                if (node.children.size() >= numeric_limits<const unsigned short>::max()) {
-                    throw "Cannot add child node because maximum number of children was reached for parent node";
+                if (tree.childCount(node) >= numeric_limits<const unsigned short>::max()) {
+                    throw TOO_MANY_CHILDREN_ERROR;
+                }
+
+                auto child = tree.addChild(node, contents, settings);
+                if (child) {
+                    searchIndex.add(path, static_cast<unsigned short>(tree.childCount(node) - 1), contents.brief);
                 }
+                return child;
+            }
+
+            // Path of the first node, in the order they were added, whose brief contains query
+            optional<vector<unsigned short>> findNode(string_view query) {
+                optional<vector<unsigned short>> match{};
+                const MenuSearchIndex* index = &searchIndex;
+                if constexpr (requires { tree.searchIndex(); }) index = &tree.searchIndex();
+                else if (searchIndexStale) rebuildSearchIndex();
+                index->forEachCandidate(query, [this, index, query, &match](MenuSearchIndex::EntryId entry) {
+                    auto path = index->pathOf(entry);
+                    auto node = tree.nodeAtRelativePath(tree.rootNode(), path);
+                    if (!node || !MenuSearchIndex::contains(tree.contents(node.value()).brief, query)) return false;
+                    match.emplace(path.begin(), path.end());
+                    return true;
+                });
+                return match;
+            }
 
-                node.children.emplace_back(
-                    make_unique<MenuNode>(
-                        contents,
-                        settings
-                    )
-                );
-                if(!node.children.back()) return{};
-                return {*(node.children.back())};
+            // Indexes the whole tree again; needed after briefs change or nodes are added without addChildNodeAtPath
+            void rebuildSearchIndex() {
+                searchIndexStale = false;
+                searchIndex.clear();
+                vector<unsigned short> path{};
+                auto indexChildren = [this, &path](auto& self, NodeRef node) -> void {
+                    unsigned short index = 0;
+                    tree.forEachChild(node, [this, &self, &path, &index](NodeRef child) {
+                        searchIndex.add(path, index, tree.contents(child).brief);
+                        path.push_back(index++);
+                        self(self, child);
+                        path.pop_back();
+                    });
+                };
+                indexChildren(indexChildren, tree.rootNode());
             }
 
             string_view userPrompt(){
-                return "\nSelect a Valid Option (or enter 'b' to go back a level; 'q' to quit):"sv;
+                if (viewport.size > 0) {
+                    return "\nSelect a Valid Option (or enter 'n'/'p' for the next/previous page; '/text' to search; 'b' to go back a level; 'q' to quit):"sv;
+                }
+                return "\nSelect a Valid Option (or enter '/text' to search; 'b' to go back a level; 'q' to quit):"sv;
             };
 
             string_view userOptionInvalid(){
@@ -373,139 +1082,630 @@ namespace consoleMenu {
                 return option-1;
             };
 
-            optional<variant<char, unsigned short>>
+            // Selections typed ahead on one line, such as "3 1 b 2"; BACK_STEP stands for 'b'
+            struct OptionRoute {
+                static constexpr unsigned short BACK_STEP = 0;
+                vector<unsigned short> steps{};
+            };
+
+            // A command character, a 1 based option number, a search query or a route of several selections
+            using UserOption = variant<char, unsigned short, string, OptionRoute>;
+
+            optional<UserOption>
             getValidUserOption(
                 istream& is,
                 ostream& os
             ) {
-               
-                auto printSV = [this](ostream& os, const string_view sv) {
-                    os << sv;
-                };
+                ioUtils::StreamInputSource source{ is };
+                return getValidUserOption(source, os);
+            }
+
+            template <ioUtils::InputSource Source>
+            optional<UserOption>
+            getValidUserOption(
+                Source& source,
+                ostream& os
+            ) {
+                auto printPromptFunction = [this](ostream& os) { os << userPrompt(); };
+                auto printInvalidInputMessage = [this](ostream& os) { os << userOptionInvalid(); };
+
+                auto isValidOptionOutput = [this](const UserOption& userOption) { return isValidOption(userOption); };
+
+                return
+                    ioUtils::getValidInput(
+                        printPromptFunction,
+                        printInvalidInputMessage,
+                        printPromptFunction,
+                        isValidOptionInput,
+                        stringToOption,
+                        isValidOptionOutput,
+                        source,
+                        os,
+                        ioUtils::InputExtent::Line
+                    );
+            }
 
-                auto printPromptFunction = bind(function(printSV), placeholders::_1, userPrompt());
-                auto printInvalidInputMessage = bind(function(printSV), placeholders::_1, userOptionInvalid());
-                auto printErrorMessage = bind(function(printSV), placeholders::_1, userPrompt());
+            // A line holds one option, or several option numbers and 'b' which are followed in turn
+            static bool isValidOptionInput(string_view userInput) {
+                userInput = trimInput(userInput);
+                if (userInput.empty()) return false;
+                if (userInput[0] == '/') return userInput.length() > MenuSearchIndex::MIN_QUERY_LENGTH;
+                if (string_view::npos != userInput.find_first_of(INPUT_WHITESPACE)) {
+                    // 0 is never an option, and in a route it would read as OptionRoute::BACK_STEP
+                    return forEachInputToken(userInput, [](string_view token) { return "b"sv == token || optionNumber(token).value_or(0) > 0; });
+                }
+                if (
+                    userInput.length() == 1 &&
+                    (userInput[0] == 'b' || userInput[0] == 'q' || userInput[0] == 'n' || userInput[0] == 'p')
+                    ) return true;
 
-                auto isValidOptionInput =
-                    [](string_view userInput) -> bool {
-                    if (
-                        userInput.length() == 1 &&
-                        userInput.at(0) == 'b' || userInput.at(0) == 'q'
-                        ) return true;
+                return optionNumber(userInput).has_value();
+            }
 
-                    using ioUtils::IntegerString;
-                    if (
-                        IntegerString::isInteger(userInput) &&
-                        !IntegerString::isNegative(userInput) &&
-                        stoull(string(userInput)) < static_cast<unsigned long long>(numeric_limits<const unsigned short>::max())
-                        ) return true;
+            // Expects userInput to pass isValidOptionInput
+            static UserOption stringToOption(string_view userInput) {
+                userInput = trimInput(userInput);
+                if (userInput[0] == '/') return string(userInput.substr(1));
+                if (string_view::npos != userInput.find_first_of(INPUT_WHITESPACE)) {
+                    OptionRoute route{};
+                    forEachInputToken(userInput, [&route](string_view token) {
+                        route.steps.push_back("b"sv == token ? OptionRoute::BACK_STEP : optionNumber(token).value());
+                        return true;
+                    });
+                    return route;
+                }
+                if (userInput.length() == 1 && userInput[0] == 'b') return { 'b' };
+                if (userInput.length() == 1 && userInput[0] == 'q') return { 'q' };
+                if (userInput.length() == 1 && userInput[0] == 'n') return { 'n' };
+                if (userInput.length() == 1 && userInput[0] == 'p') return { 'p' };
+                return optionNumber(userInput).value();
+            }
 
-                    return false;
-                };
+            // Whether the option can be applied at the current node
+            bool isValidOption(const UserOption& userOption) {
+                refreshTree(); // Options are checked against and applied to the latest version of the tree
+                if (holds_alternative<string>(userOption)) return true;
+                if (holds_alternative<char>(userOption)) {
+                    auto charOpt = get<char>(userOption);
+                    if (charOpt == 'b' || charOpt == 'q') return true;
+                    if ((charOpt == 'n' || charOpt == 'p') && viewport.size > 0) return true;
+                }
+                else if (holds_alternative<unsigned short>(userOption)) {
+                    auto numOpt = get<unsigned short>(userOption);
+                    if ( numOpt > 0 && numOpt <= tree.childCount(currentNode())) return true;
+                }
+                else if (holds_alternative<OptionRoute>(userOption)) {
+                    return isValidRoute(get<OptionRoute>(userOption));
+                }
+                return false;
+            }
 
-                auto stringToOption =
-                    [](string_view userInput) -> variant<char, unsigned short> {
-                    if (userInput.length() == 1 && userInput.at(0) == 'b') return { 'b' };
-                    if (userInput.length() == 1 && userInput.at(0) == 'q') return { 'q' };
-                    return static_cast<unsigned short>(stoull(string(userInput)));
-                };
+            /**
+            * Whether every step of route can be taken from the current node, checked without moving,
+            * so no lazy node is expanded and the cursor is left alone.
+            * Steps below a lazy node whose children are not provided yet can only be checked by followRoute.
+            */
+            bool isValidRoute(const OptionRoute& route) {
+                auto path = currentMenuPath;
+                auto node = currentNode();
+                for (auto step : route.steps) {
+                    if (OptionRoute::BACK_STEP == step) {
+                        if (path.empty()) return false;
+                        path.pop_back();
+                        node = tree.nodeAtRelativePath(tree.rootNode(), path).value();
+                        continue;
+                    }
+                    if (tree.isExpandable(node)) return true;
+                    auto child = tree.childAt(node, optionToNodeIndex(step));
+                    if (!child) return false;
+                    path.push_back(optionToNodeIndex(step));
+                    node = child.value();
+                }
+                return true;
+            }
 
-                auto isValidOptionOutput =
-                    [this](const variant<char, unsigned short>& userOption) -> bool {
-                    if (holds_alternative<char>(userOption)) {
-                        auto charOpt = get<char>(userOption);
-                        if (charOpt == 'b' || charOpt == 'q') return true;
+            // Applies every step of route without rendering; leaves the menu where it was if a step fails
+            bool followRoute(const OptionRoute& route) {
+                auto startPath = currentMenuPath;
+                auto startPage = viewport.start;
+                for (auto step : route.steps) {
+                    bool followed = false;
+                    if (OptionRoute::BACK_STEP == step) {
+                        if (!currentMenuPath.empty()) viewport.start = currentMenuPath.back();
+                        followed = goBack();
+                    } else {
+                        followed = selectChild(optionToNodeIndex(step));
+                        if (followed) viewport.start = 0;
                     }
-                    else if (holds_alternative<unsigned short>(userOption)) {
-                        auto numOpt = get<unsigned short>(userOption);
-                        const auto& currentNode = this->root.nodeAtRelativePath(currentMenuPath).value().get();
-                        if ( numOpt > 0 && numOpt <= currentNode.children.size()) return true;
+                    if (!followed) {
+                        navigateTo(startPath);
+                        viewport.start = startPage;
+                        return false;
                     }
-                    return false;
-                };
+                }
+                return true;
+            }
 
-                return
-                    ioUtils::getValidInput(
-                        printPromptFunction,
-                        printInvalidInputMessage,
-                        printErrorMessage,
-                        function(isValidOptionInput),
-                        {},
-                        function(stringToOption),
-                        {},
-                        function(isValidOptionOutput),
-                        {},
-                        is,
-                        os
-                    );
+            static constexpr string_view INPUT_WHITESPACE = " \t\r\v\f"sv;
+
+            static string_view trimInput(string_view userInput) {
+                auto start = userInput.find_first_not_of(INPUT_WHITESPACE);
+                if (string_view::npos == start) return {};
+                return userInput.substr(start, userInput.find_last_not_of(INPUT_WHITESPACE) - start + 1);
+            }
+
+            // Calls f on every whitespace separated token of userInput; false as soon as f returns false
+            template <typename F>
+            static bool forEachInputToken(string_view userInput, F&& f) {
+                auto start = userInput.find_first_not_of(INPUT_WHITESPACE);
+                while (string_view::npos != start) {
+                    auto end = userInput.find_first_of(INPUT_WHITESPACE, start);
+                    if (!f(userInput.substr(start, end - start))) return false;
+                    start = userInput.find_first_not_of(INPUT_WHITESPACE, end);
+                }
+                return true;
             }
 
+            // Option number of a non negative integer below the largest unsigned short, without allocating
+            static optional<unsigned short> optionNumber(string_view userInput) {
+                auto number = ioUtils::parseNumber<unsigned short>(userInput);
+                if (!number || number.value() == numeric_limits<unsigned short>::max()) return {};
+                return number;
+            }
+
+
+            ostream& drawFrameIncrementally(ostream& os, string_view frame) {
+                auto& lines = frameLines;
+                lines.clear();
+                size_t lineStart = 0;
+                while (true) {
+                    auto lineEnd = frame.find('\n', lineStart);
+                    lines.emplace_back(frame.substr(lineStart, lineEnd - lineStart));
+                    if (lineEnd == string_view::npos) break;
+                    lineStart = lineEnd + 1;
+                }
+
+                outputBuffer.clear();
+                // Nothing drawn yet so start from a blank screen
+                if (0 == previousFrameLineCount) {
+                    osUtils::moveCursor(outputBuffer, 1, 1);
+                    osUtils::clearToEndOfScreen(outputBuffer);
+                }
+
+                for (size_t row = 0; row < lines.size(); ++row) {
+                    if (row < previousFrameLineCount && previousFrameLines[row] == lines[row]) continue;
+                    osUtils::moveCursor(outputBuffer, row + 1, 1) += lines[row];
+                    osUtils::clearToEndOfLine(outputBuffer);
+                }
+
+                // Erase everything below the frame (longer frames, prompts and echoed input)
+                // and leave the cursor at the end of the frame like a full redraw would
+                osUtils::moveCursor(outputBuffer, lines.size() + 1, 1);
+                osUtils::clearToEndOfScreen(outputBuffer);
+                osUtils::moveCursor(outputBuffer, lines.size(), lines.back().length() + 1);
+
+                // Lines are assigned in place so their capacity is kept for the next frame
+                if (previousFrameLines.size() < lines.size()) previousFrameLines.resize(lines.size());
+                for (size_t row = 0; row < lines.size(); ++row) previousFrameLines[row].assign(lines[row]);
+                previousFrameLineCount = lines.size();
+                return os.write(outputBuffer.data(), outputBuffer.size());
+            }
 
             void displayMenu(istream &is, ostream& os) {
-                
+                ioUtils::StreamInputSource source{ is };
+                displayMenu(source, os);
+            }
+
+            // displayMenu reading lines from any InputSource, such as an FdInputSource over a pipe or file
+            template <ioUtils::InputSource Source>
+            void displayMenu(Source& source, ostream& os) {
                 bool exit = false;
-                auto clearScreenIfStdOut = [&os]() {
-                    if (os.rdbuf() == cout.rdbuf()) {
-                        osUtils::clearScreen();
-                    }
-                };
 
-                clearScreenIfStdOut();
-                getMenuFromRootPath(os,{});
+                resetCursor();
+                redrawFrame(os);
 
                 while(!exit){
-                    cout << "\ncurrentPath=" << pathString(currentMenuPath);
-                    auto userInput = getValidUserOption(is, os);
+                    auto userInput = getValidUserOption(source, os);
                     
                     if (!userInput.has_value()) {
                         os << userOptionError();
                         return; 
                     }
 
-                    auto &userOption = userInput.value();
-                    span currentPathSpan = currentMenuPath ;
-                    auto currentPathLength = currentPathSpan.size();
-                    
-                    if (holds_alternative<char>(userOption)) {
-                        char charOption = get<char>(userOption);
-                        if (charOption == 'q') {
-                            exit = true;
-                            break;
-                        }else if (charOption == 'b') {
-                            // Calculate New Path
-                            if (0 == currentPathLength) {
-                                os << "\n This is the top level menu. Cannot go back\n";
-                                continue;
-                            }
-                            auto newPathSpan = currentPathSpan.first(currentPathLength - 1);
-
-                            // Print Menu
-                            clearScreenIfStdOut();
-                            changeMenu(os, currentPathSpan, newPathSpan);
-
-                            // Update Path
-                            auto lastPathIterator = prev(currentMenuPath.end());
-                            currentMenuPath.erase(lastPathIterator);
+                    exit = !showOutcome(os, applyUserOption(userInput.value()));
+                }
+            }
+
+#if defined(__linux__)
+            /**
+            * @brief displayMenu as a coroutine which waits on loop instead of blocking on input
+            *
+            * Whenever inputFd becomes readable the available input is read and every complete line
+            * is handled like displayMenu does. Other coroutines on loop run in between.
+            * The menu has to outlive the returned task.
+            */
+            osUtils::Task displayMenuAsync(osUtils::EventLoop& loop, int inputFd, ostream& os) {
+                string pendingInput{};
+                char chunk[4096];
+
+                resetCursor();
+                redrawFrame(os);
+                os << userPrompt() << std::flush;
+                while (true) {
+                    co_await loop.readable(inputFd);
+                    auto bytesRead = ::read(inputFd, chunk, sizeof(chunk));
+                    if (bytesRead < 0 && (EINTR == errno || EAGAIN == errno)) continue;
+                    if (bytesRead <= 0) {
+                        // The last line may end without a newline
+                        if (!pendingInput.empty() && !handleInputLine(os, pendingInput)) co_return;
+                        os << userOptionError() << std::flush;
+                        co_return;
+                    }
+
+                    pendingInput.append(chunk, static_cast<size_t>(bytesRead));
+                    size_t lineStart = 0;
+                    for (auto lineEnd = pendingInput.find('\n'); lineEnd != string::npos; lineEnd = pendingInput.find('\n', lineStart)) {
+                        auto line = string_view{ pendingInput }.substr(lineStart, lineEnd - lineStart);
+                        lineStart = lineEnd + 1;
+                        if (!handleInputLine(os, line)) {
+                            os.flush();
+                            co_return;
                         }
-                    }else if (holds_alternative<unsigned short>(userOption)) {
-                        // Update Path
-                        auto selectedNodeIndex = optionToNodeIndex(get<unsigned short >(userOption));
-                        currentMenuPath.emplace_back(selectedNodeIndex);
+                    }
+                    pendingInput.erase(0, lineStart);
+                    os.flush();
+                }
+            }
+#endif
 
-                        // Print Menu
-                        clearScreenIfStdOut();
-                        changeMenu(os, currentPathSpan, currentMenuPath);
+            /**
+            * @brief navigates like displayMenu without rendering, prompting or clearing the screen
+            *
+            * Reads whitespace separated selections ('b', 'q', 'n', 'p', '/text' or an option number)
+            * until 'q' or the end of is. Selections which cannot be applied are skipped and reported.
+            *
+            * @param record receives one tab separated line per step and a final line, as chosen by recordMode
+            * @return the path at the end of the run and every skipped selection
+            */
+            BatchResult runBatch(istream& is, ostream& record, BatchRecord recordMode = BatchRecord::None) {
+                ioUtils::StreamInputSource source{ is };
+                return runBatch(source, record, recordMode);
+            }
 
-                    }else {
-                        os << userOptionError();
+            /**
+            * @brief runBatch reading selections from any InputSource, such as an FdInputSource over a pipe
+            */
+            template <ioUtils::InputSource Source>
+            BatchResult runBatch(Source& source, ostream& record, BatchRecord recordMode = BatchRecord::None) {
+                BatchResult result{};
+                resetCursor();
+
+                while (auto read = source.readToken()) {
+                    string_view token{ *read };
+                    ++result.steps;
+                    auto outcome = applyUserInput(token);
+
+                    bool applied = OptionOutcome::Moved == outcome || OptionOutcome::Quit == outcome;
+                    if (!applied) result.invalidSelections.push_back({ result.steps, string{ token }, outcome });
+                    if (BatchRecord::PerStep == recordMode) {
+                        record << result.steps << '\t' << token << '\t' << outcomeName(outcome) << '\t' << pathString(currentMenuPath) << '\n';
+                    }
+                    if (OptionOutcome::Quit == outcome) break;
+                }
+
+                result.finalPath = currentMenuPath;
+                if (BatchRecord::None != recordMode) {
+                    record << "final\t" << result.steps << '\t' << result.invalidSelections.size() << '\t' << pathString(currentMenuPath) << '\n';
+                }
+                return result;
+            }
+
+            // Parses, checks and applies a line of user input such as "2", "b" or "/text"
+            OptionOutcome applyUserInput(string_view userInput) {
+                if (!isValidOptionInput(userInput)) return OptionOutcome::InvalidOption;
+                auto userOption = stringToOption(userInput);
+                if (!isValidOption(userOption)) return OptionOutcome::InvalidOption;
+                return applyUserOption(userOption);
+            }
+
+            // Applies an option which passed isValidOption and reports what happened
+            OptionOutcome applyUserOption(const UserOption& userOption) {
+                refreshTree();
+                if (holds_alternative<char>(userOption)) {
+                    char charOption = get<char>(userOption);
+                    if (charOption == 'q') return OptionOutcome::Quit;
+                    if (charOption == 'b') {
+                        if (currentMenuPath.empty()) return OptionOutcome::AtTopLevel;
+                        viewport.start = currentMenuPath.back(); // Return to the page of the node we are leaving
+                        goBack();
+                        return OptionOutcome::Moved;
+                    }
+                    if (charOption == 'n' || charOption == 'p') {
+                        auto pageStart = viewport.start - viewport.start % viewport.size;
+                        if (charOption == 'n' && pageStart + viewport.size < tree.childCount(currentNode())) {
+                            viewport.start = pageStart + viewport.size;
+                        }else if (charOption == 'p' && pageStart >= viewport.size) {
+                            viewport.start = pageStart - viewport.size;
+                        }else {
+                            return OptionOutcome::NoMorePages;
+                        }
+                        return OptionOutcome::Moved;
+                    }
+                }else if (holds_alternative<string>(userOption)) {
+                    auto match = findNode(get<string>(userOption));
+                    if (!match) return OptionOutcome::NoSearchMatch;
+                    navigateTo(match.value());
+                    viewport.start = 0;
+                    return OptionOutcome::Moved;
+                }else if (holds_alternative<unsigned short>(userOption)) {
+                    if (!selectChild(optionToNodeIndex(get<unsigned short>(userOption)))) return OptionOutcome::InvalidOption;
+                    viewport.start = 0;
+                    return OptionOutcome::Moved;
+                }else if (holds_alternative<OptionRoute>(userOption)) {
+                    // Only the destination is rendered when the outcome is shown
+                    if (!followRoute(get<OptionRoute>(userOption))) return OptionOutcome::InvalidOption;
+                    return OptionOutcome::Moved;
+                }
+                return OptionOutcome::InvalidOption;
+            }
+
+            static string_view outcomeName(OptionOutcome outcome) {
+                switch (outcome) {
+                    case OptionOutcome::Moved: return "moved"sv;
+                    case OptionOutcome::Quit: return "quit"sv;
+                    case OptionOutcome::AtTopLevel: return "at-top-level"sv;
+                    case OptionOutcome::NoMorePages: return "no-more-pages"sv;
+                    case OptionOutcome::NoSearchMatch: return "no-search-match"sv;
+                    case OptionOutcome::Highlighted: return "highlighted"sv;
+                    default: return "invalid-option"sv;
+                }
+            }
+
+            /**
+            * @brief navigates with single keystrokes read from a terminal in raw mode
+            *
+            * Up, Down, Home and End move the highlight and Enter or Right select it; Left and Backspace go back.
+            * Digits select as soon as no further digit could name an option, 'b', 'q', 'n' and 'p' act at once,
+            * and '/' starts a search which Enter runs. Falls back to displayMenu reading lines from inputFd if it is no terminal.
+            */
+            void displayMenuWithKeys(ostream& os = cout, int inputFd = 0) {
+                osUtils::RawTerminal terminal{ inputFd };
+                if (!terminal.isActive()) {
+                    ioUtils::FdInputSource source{ inputFd };
+                    displayMenu(source, os);
+                    return;
+                }
+
+                auto draw = [this, &os]() {
+                    redrawFrame(os);
+                    writeKeyPrompt(os).flush();
+                };
+
+                resetCursor();
+                keyInput = {};
+                draw();
+                while (true) {
+                    auto outcome = handleKey(terminal.readKey());
+                    if (outcome && OptionOutcome::Quit == outcome.value()) {
+                        os << '\n';
                         return;
                     }
+                    draw();
+                    if (!outcome) continue;
+                    switch (outcome.value()) {
+                        case OptionOutcome::AtTopLevel:
+                            os << "\n This is the top level menu. Cannot go back";
+                            break;
+                        case OptionOutcome::NoMorePages:
+                            os << "\n There are no more pages in this direction";
+                            break;
+                        case OptionOutcome::NoSearchMatch:
+                            os << "\n No menu item matches the search";
+                            break;
+                        case OptionOutcome::InvalidOption:
+                            os << userOptionInvalid();
+                            break;
+                        default:
+                            break;
+                    }
+                    os.flush();
+                }
+            }
+
+            // Applies a keystroke; empty while an option number or a search is still being typed
+            optional<OptionOutcome> handleKey(const osUtils::KeyPress& keyPress) {
+                using osUtils::Key;
+                auto& typed = keyInput.typed;
+                auto childCount = tree.childCount(currentNode());
+
+                if (!typed.empty() && '/' == typed[0]) {
+                    if (Key::Character == keyPress.key) typed += keyPress.character;
+                    if (Key::Backspace == keyPress.key) typed.pop_back();
+                    if (Key::Escape == keyPress.key) typed.clear();
+                    if (Key::Enter == keyPress.key) return applyTyped();
+                    return {};
+                }
+
+                switch (keyPress.key) {
+                    case Key::Character:
+                        if (keyPress.character >= '0' && keyPress.character <= '9') {
+                            typed += keyPress.character;
+                            auto number = optionNumber(typed);
+                            // Select as soon as another digit could not name an option any more
+                            if (number && static_cast<size_t>(number.value()) * 10 > childCount) return applyTyped();
+                            return {};
+                        }
+                        typed.assign(1, keyPress.character);
+                        if ('/' == keyPress.character) return {};
+                        return applyTyped();
+                    case Key::Enter:
+                        if (typed.empty()) return selectHighlighted();
+                        return applyTyped();
+                    case Key::Right:
+                        return selectHighlighted();
+                    case Key::Left:
+                        typed = "b";
+                        return applyTyped();
+                    case Key::Backspace:
+                        if (!typed.empty()) {
+                            typed.pop_back();
+                            return {};
+                        }
+                        typed = "b";
+                        return applyTyped();
+                    case Key::Escape:
+                        typed.clear();
+                        return {};
+                    case Key::Up:
+                        return highlight(keyInput.highlight > 0 ? keyInput.highlight - 1 : 0);
+                    case Key::Down:
+                        return highlight(keyInput.highlight + 1 < childCount ? keyInput.highlight + 1 : keyInput.highlight);
+                    case Key::Home:
+                        return highlight(0);
+                    case Key::End:
+                        return highlight(childCount > 0 ? childCount - 1 : 0);
+                    case Key::EndOfInput:
+                        return OptionOutcome::Quit;
+                    default:
+                        return {};
+                }
+            }
+
+            // The highlighted option and what has been typed, below the frame
+            ostream& writeKeyPrompt(ostream& os) {
+                os << "\n> ";
+                auto highlighted = tree.childAt(currentNode(), keyInput.highlight);
+                if (highlighted) os << keyInput.highlight + 1 << ". " << tree.contents(highlighted.value()).brief << ' ';
+                return os << keyInput.typed;
+            }
+
+        private:
+            vector<string> previousFrameLines{}; // Lines of the last frame drawn incrementally; only grows
+            size_t previousFrameLineCount{0};
+            vector<string_view> frameLines{};
+            string outputBuffer{};               // Escape sequences and changed lines of an incremental draw
+
+            // Shows the result of an option; false once the menu should close
+            bool showOutcome(ostream& os, OptionOutcome outcome) {
+                switch (outcome) {
+                    case OptionOutcome::Moved:
+                        redrawFrame(os);
+                        return true;
+                    case OptionOutcome::Quit:
+                        return false;
+                    case OptionOutcome::AtTopLevel:
+                        os << "\n This is the top level menu. Cannot go back\n";
+                        return true;
+                    case OptionOutcome::NoMorePages:
+                        os << "\n There are no more pages in this direction\n";
+                        return true;
+                    case OptionOutcome::NoSearchMatch:
+                        os << "\n No menu item matches the search\n";
+                        return true;
+                    default:
+                        os << userOptionError();
+                        return false;
+                }
+            }
+
+            // Handles a line of input like displayMenu does and prompts for the next one; false once the menu should close
+            bool handleInputLine(ostream& os, string_view line) {
+                auto outcome = applyUserInput(line);
+                if (OptionOutcome::InvalidOption == outcome) {
+                    os << userOptionInvalid();
+                } else if (!showOutcome(os, outcome)) {
+                    return false;
+                }
+                os << userPrompt();
+                return true;
+            }
+
+            void redrawFrame(ostream& os) {
+                auto frame = renderFrame(currentMenuPath);
+                if (RenderMode::Incremental == renderMode && osUtils::isTerminal(os)) {
+                    drawFrameIncrementally(os, frame);
+                } else {
+                    previousFrameLineCount = 0;
+                    if (osUtils::isTerminal(os)) osUtils::clearScreen(os, clearMethod);
+                    os.write(frame.data(), frame.size());
+                }
+            }
+
+            // Applies keyInput.typed as an option; the highlight follows the page shown afterwards
+            OptionOutcome applyTyped() {
+                auto outcome = applyUserInput(keyInput.typed);
+                keyInput.typed.clear();
+                if (OptionOutcome::Moved == outcome) keyInput.highlight = viewport.start;
+                return outcome;
+            }
+
+            OptionOutcome selectHighlighted() {
+                auto option = static_cast<unsigned short>(keyInput.highlight + 1);
+                if (!isValidOption(option)) return OptionOutcome::InvalidOption;
+                auto outcome = applyUserOption(option);
+                keyInput.typed.clear();
+                if (OptionOutcome::Moved == outcome) keyInput.highlight = viewport.start;
+                return outcome;
+            }
+
+            // Moves the highlight and the page shown with it
+            OptionOutcome highlight(size_t index) {
+                keyInput.highlight = index;
+                viewport.start = index;
+                return OptionOutcome::Highlighted;
+            }
+
+            // Empties the cursor without giving up the capacity of its vector
+            void clearCursor() {
+                while (!cursor.empty()) cursor.pop();
+            }
+
+            struct ExpandedLazyNode {
+                vector<unsigned short> path{};
+                size_t childCount{0};
+            };
+            list<ExpandedLazyNode> expandedLazyNodes{}; // Most recently used first
+            size_t lazyChildCount{0};
+            bool searchIndexStale{ false }; // Set when the tree has nodes the index does not cover, from the constructor or refreshTree
+
+            static bool isPrefixOf(span<const unsigned short> prefix, span<const unsigned short> path) {
+                return prefix.size() <= path.size() && std::ranges::equal(prefix, path.first(prefix.size()));
+            }
+
+            // Drops the bookkeeping for expanded nodes below path, whose children are about to go away
+            void forgetExpandedBelow(span<const unsigned short> path) {
+                expandedLazyNodes.remove_if([this, path](const ExpandedLazyNode& lazyNode) {
+                    if (!isPrefixOf(path, lazyNode.path)) return false;
+                    lazyChildCount -= lazyNode.childCount;
+                    return true;
+                });
+            }
+
+            void evictLazyNodes() {
+                while (lazyChildBudget > 0 && lazyChildCount > lazyChildBudget) {
+                    // Nodes on the way to the current node stay expanded
+                    auto victim = find_if(expandedLazyNodes.rbegin(), expandedLazyNodes.rend(),
+                        [this](const ExpandedLazyNode& lazyNode) { return !isPrefixOf(lazyNode.path, currentMenuPath); });
+                    if (victim == expandedLazyNodes.rend()) return;
+
+                    auto victimPath = victim->path;
+                    auto node = tree.nodeAtRelativePath(tree.rootNode(), victimPath);
+                    forgetExpandedBelow(victimPath);
+                    if (node) tree.collapse(node.value());
                 }
             }
     };
 
-    Menu& getMenu() {
+    using Menu = BasicMenu<MenuNodeTree>;
+    using PooledMenu = BasicMenu<MenuNodePool>;
+
+    // View of menu's tree and search index which keeps menu alive
+    template <class Tree>
+    SharedMenuTree<Tree> shareMenuTree(const shared_ptr<BasicMenu<Tree>>& menu) {
+        return { shared_ptr<Tree>{ menu, &menu->tree }, shared_ptr<const MenuSearchIndex>{ menu, &menu->searchIndex } };
+    }
+
+    inline Menu& getMenu() {
         static Menu mainMenu;
         return mainMenu;
     }
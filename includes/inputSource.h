@@ -0,0 +1,92 @@
+#pragma once
+/*********************************************************************
+ * @file  inputSource.h
+ *
+ * @brief Sources of tokens and lines for the getValidInput pipeline:
+ *        an adapter over istream, and a buffered reader of a file
+ *        descriptor which hands out views into its buffer
+ *
+ *********************************************************************/
+
+#include <concepts>
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace ioUtils {
+    using std::istream;
+    using std::optional;
+    using std::same_as;
+    using std::size_t;
+    using std::string_view;
+    using std::vector;
+}
+
+namespace ioUtils {
+
+    /**
+    * What getValidInput reads from:
+    * - hasUnextractedInput: whether input is left which does not start with a newline
+    * - readToken: the next whitespace separated token, skipping leading whitespace; empty once the input ends
+    * - readLine: the rest of the line without its newline; empty once the input ends
+    * - skipLine: discards the rest of the line and recovers from a failed read
+    *
+    * The views a source returns stay valid until the next call on it.
+    */
+    template <typename S>
+    concept InputSource = requires(S& source) {
+        { source.hasUnextractedInput() } -> same_as<bool>;
+        { source.readToken() } -> same_as<optional<string_view>>;
+        { source.readLine() } -> same_as<optional<string_view>>;
+        source.skipLine();
+    };
+
+    /**
+    * InputSource over an istream, which reads tokens and lines into inputTokenBuffer()
+    */
+    class StreamInputSource {
+        public:
+            explicit StreamInputSource(istream& is) : is{ is } {}
+
+            bool hasUnextractedInput();
+            optional<string_view> readToken();
+            optional<string_view> readLine();
+            void skipLine();
+
+        private:
+            istream& is;
+    };
+
+    /**
+    * InputSource which reads a blocking file descriptor, such as a pipe or a file, with one
+    * read call per buffer full. Tokens and lines are views into the buffer, which only grows
+    * when a single token or line does not fit into it. The descriptor is not closed.
+    */
+    class FdInputSource {
+        public:
+            static constexpr size_t DEFAULT_BUFFER_SIZE = size_t{ 1 } << 16;
+
+            explicit FdInputSource(int fd, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+            bool hasUnextractedInput();
+            optional<string_view> readToken();
+            optional<string_view> readLine();
+            void skipLine();
+
+        private:
+            int fd;
+            vector<char> buffer;
+            size_t begin{0}; //!< First unconsumed byte
+            size_t end{0};   //!< One past the last byte read
+            bool endOfInput{false};
+
+            // Moves the unconsumed bytes to the front, growing the buffer if they fill it, and reads more
+            bool fill();
+            string_view unconsumed() const { return { buffer.data() + begin, end - begin }; }
+    };
+
+    static_assert(InputSource<StreamInputSource>);
+    static_assert(InputSource<FdInputSource>);
+}
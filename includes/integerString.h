@@ -2,7 +2,7 @@
 /*********************************************************************
  * @file  integerString.h
  *
- * @brief Class integerString for a string representation of an integer
+ * @brief Class integerString for an integer of any size read from and written as text
  *
  *********************************************************************/
 
@@ -11,6 +11,8 @@
 #include <string_view>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <vector>
 
 namespace ioUtils{
     using std::swap;
@@ -20,21 +22,39 @@ namespace ioUtils{
     using std::istream;
     using std::ostream;
     using std::find_if_not;
+    using std::uint32_t;
+    using std::vector;
 }
 
 namespace ioUtils {
    
+    /**
+    * Integer stored as base 10^9 limbs, least significant first, so that comparisons
+    * and arithmetic work on a word at a time instead of a digit at a time.
+    * An IntegerString made from text which is not an integer has no limbs and is not valid;
+    * arithmetic on it gives an invalid result.
+    */
     class IntegerString {
         private :
-            string numberString;
+            static constexpr uint32_t LIMB_BASE = 1000000000;
+            static constexpr size_t LIMB_DIGITS = 9;
+
+            vector<uint32_t> limbs;
             bool negative = false;
             static constexpr unsigned short charToDigit(char a);
             static constexpr bool charIsDigit(char a);
+
+            // -1, 0 or 1 as the magnitude of a is smaller than, equal to or larger than that of b
+            static int compareMagnitudes(const vector<uint32_t>& a, const vector<uint32_t>& b);
+            static void addMagnitude(vector<uint32_t>& a, const vector<uint32_t>& b);
+            static void subtractMagnitude(vector<uint32_t>& a, const vector<uint32_t>& b); // Expects |a| >= |b|
+            IntegerString& addSigned(const IntegerString& other, bool otherNegative);
+            void normalize(); // Drops leading zero limbs; zero is never negative
         public :
 
             struct DigitInString{
                 unsigned short digit;
-                decltype(numberString.begin())::difference_type positionInString;
+                string_view::difference_type positionInString;
             };
 
             static constexpr bool isInteger(string_view maybeInteger);
@@ -48,8 +68,8 @@ namespace ioUtils {
 
             void reset(const string_view number);
 
-            inline string toString() const;
-            inline bool valid(){return !numberString.empty();};
+            string toString() const;
+            inline bool valid() const {return !limbs.empty();};
 
             bool operator < (const IntegerString& other) const;
             inline bool operator > (const IntegerString& other) const { return other < *this; }
@@ -58,19 +78,26 @@ namespace ioUtils {
             
             bool operator == (const IntegerString& other) const;
             inline bool operator != (const IntegerString& other) const { return !(*this == other); };
+
+            IntegerString& operator += (const IntegerString& other) { return addSigned(other, other.negative); }
+            IntegerString& operator -= (const IntegerString& other) { return addSigned(other, !other.negative); }
+            IntegerString& operator *= (const IntegerString& other);
+            friend IntegerString operator + (IntegerString a, const IntegerString& b) { return a += b; }
+            friend IntegerString operator - (IntegerString a, const IntegerString& b) { return a -= b; }
+            friend IntegerString operator * (IntegerString a, const IntegerString& b) { return a *= b; }
             friend istream& operator >> (istream& is, IntegerString& integerString);
             friend ostream& operator << (ostream& os, const IntegerString& integerString);
 
             // Constructors, Copy/Move Operators and Destructor 
             IntegerString():
-                numberString{},
+                limbs{},
                 negative{false}{
             }
 
             explicit IntegerString(const string_view number);
             
             IntegerString(const IntegerString& other) :
-                numberString{other.numberString},
+                limbs{other.limbs},
                 negative{ other.negative } {
             }
 
@@ -79,20 +106,20 @@ namespace ioUtils {
                     return *this;
 
                 IntegerString temp{other}; 
-                swap(numberString, temp.numberString); 
+                swap(limbs, temp.limbs); 
                 swap(negative, temp.negative); 
                 return *this;
             }
 
             IntegerString(IntegerString&& other) noexcept :
-                numberString{ move(other.numberString) },
+                limbs{ move(other.limbs) },
                 negative{ other.negative } {
             }
 
             IntegerString& operator=(IntegerString&& other) noexcept 
             {
                 IntegerString temp{move(other)};
-                swap(numberString, temp.numberString);
+                swap(limbs, temp.limbs);
                 swap(negative, temp.negative);
                 return *this;
             }
@@ -103,25 +130,10 @@ namespace ioUtils {
 
     // Definitions of inline and constexpr functions
     inline void IntegerString::clear(){
-        numberString.clear();
+        limbs.clear();
         negative = false;
     }
 
-    inline void IntegerString::reset(const string_view number) {
-        clear();
-        numberString = getAbsoluteValueString(number);
-        if (!numberString.empty()) negative = isNegative(number);
-    }
-
-    inline std::string IntegerString::toString() const{
-    
-        std::string representation;
-        if (negative) representation = '-';
-        representation += numberString;
-
-        return representation;
-    };
-
     constexpr bool IntegerString::charIsDigit(char a) {
         if (a >= '0' && a <= '9') return true;
         return false;
@@ -153,11 +165,12 @@ namespace ioUtils {
 
     constexpr bool IntegerString::isInteger(string_view maybeInteger) {
 
+        if (maybeInteger.empty()) return false;
         auto beg = maybeInteger.begin();
 
         // Check if starting character is '+' or '-' and move the beginning iterator if that is the case
-        if (maybeInteger.at(0) == '+' || maybeInteger.at(0) == '-') {
-            beg = next(beg);
+        if (maybeInteger[0] == '+' || maybeInteger[0] == '-') {
+            beg = std::next(beg);
         }
 
         // If String is now empty return false
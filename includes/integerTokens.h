@@ -0,0 +1,42 @@
+#pragma once
+/*********************************************************************
+ * @file  integerTokens.h
+ *
+ * @brief Splitting of bulk input into tokens and checking which of
+ *        them are integers, 64 bytes at a time with SIMD where available
+ *
+ *********************************************************************/
+
+#include "osCpu.h"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace ioUtils {
+    using std::size_t;
+    using std::string_view;
+    using std::vector;
+    using osUtils::ScanPath;
+    using osUtils::bestScanPath;
+}
+
+namespace ioUtils {
+
+    struct IntegerToken {
+        size_t offset{0}; //!< Position of the token's first character in the input
+        size_t length{0};
+        bool valid{false}; //!< An optional '+' or '-' followed by at least one digit, like IntegerString::isInteger
+        bool operator==(const IntegerToken& other) const = default;
+    };
+
+    /**
+    * @brief splits input at whitespace and commas and checks whether every token is an integer
+    *
+    * Digits, signs and separators are classified for a whole block at once, so the bytes
+    * inside a token are never looked at one by one.
+    *
+    * @param tokens replaced by the tokens of input in order; its capacity is reused
+    * @param path how the bytes of each block are classified; a path the processor does not support falls back to bestScanPath()
+    */
+    void scanIntegerTokens(string_view input, vector<IntegerToken>& tokens, ScanPath path = bestScanPath());
+}
@@ -1,3 +1,6 @@
 #pragma once
 #include "userInput.h"
 #include "integerString.h"
+#include "numberParser.h"
+#include "integerTokens.h"
+#include "inputSource.h"
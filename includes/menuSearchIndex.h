@@ -0,0 +1,154 @@
+#pragma once
+/*********************************************************************
+ * @file  menuSearchIndex.h
+ *
+ * @brief Class MenuSearchIndex for finding menu nodes by the text of their brief
+ *
+ *********************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace consoleMenu {
+    using std::uint32_t;
+    using std::span;
+    using std::string_view;
+    using std::unordered_map;
+    using std::vector;
+    using std::binary_search;
+    using std::sort;
+    using std::all_of;
+    using std::equal;
+    using std::next;
+}
+
+namespace consoleMenu {
+
+    /**
+    * Case insensitive trigram index over the briefs of a menu.
+    * Every indexed node is an entry holding its path from the root; entries are
+    * numbered in the order they are added so posting lists stay sorted.
+    * The index only proposes candidates; callers confirm them against the current brief.
+    */
+    class MenuSearchIndex {
+        public:
+            using EntryId = uint32_t;
+
+            static constexpr size_t MIN_QUERY_LENGTH = 2;
+
+            size_t size() const { return pathOffsets.size() - 1; }
+
+            void clear() {
+                paths.clear();
+                pathOffsets.assign(1, 0);
+                postings.clear();
+            }
+
+            span<const unsigned short> pathOf(EntryId entry) const {
+                return span<const unsigned short>{ paths }.subspan(
+                    pathOffsets[entry],
+                    pathOffsets[entry + 1] - pathOffsets[entry]
+                );
+            }
+
+            EntryId add(span<const unsigned short> parentPath, unsigned short indexInParent, string_view brief) {
+                auto entry = static_cast<EntryId>(size());
+                paths.insert(paths.end(), parentPath.begin(), parentPath.end());
+                paths.push_back(indexInParent);
+                pathOffsets.push_back(paths.size());
+
+                forEachIndexTrigram(brief, [this, entry](uint32_t key) {
+                    auto& posting = postings[key];
+                    if (posting.empty() || posting.back() != entry) posting.push_back(entry);
+                });
+                return entry;
+            }
+
+            /**
+            * @brief calls isMatch(entry) on every entry containing all trigrams of query, in entry order
+            *
+            * @param query text to look for; shorter queries than three characters only match the start of a word
+            * @param isMatch callback confirming a candidate; returning true stops the search
+            */
+            template <typename F>
+            void forEachCandidate(string_view query, F&& isMatch) const {
+                if (query.length() < MIN_QUERY_LENGTH) return;
+
+                vector<const vector<EntryId>*> queryPostings{};
+                bool missingTrigram = false;
+                forEachQueryTrigram(query, [this, &queryPostings, &missingTrigram](uint32_t key) {
+                    auto posting = postings.find(key);
+                    if (posting == postings.end()) {
+                        missingTrigram = true;
+                    } else {
+                        queryPostings.push_back(&posting->second);
+                    }
+                });
+                if (missingTrigram || queryPostings.empty()) return;
+
+                // Walk the rarest trigram and look the candidates up in the others
+                sort(queryPostings.begin(), queryPostings.end(),
+                    [](const auto* a, const auto* b) { return a->size() < b->size(); });
+                for (auto entry : *queryPostings.front()) {
+                    bool inAll = all_of(next(queryPostings.begin()), queryPostings.end(),
+                        [entry](const auto* posting) { return binary_search(posting->begin(), posting->end(), entry); });
+                    if (inAll && isMatch(entry)) return;
+                }
+            }
+
+            static constexpr char toLower(char a) {
+                if (a >= 'A' && a <= 'Z') return static_cast<char>(a - 'A' + 'a');
+                return a;
+            }
+
+            // Case insensitive search for needle in haystack; a short needle has to start a word
+            static bool contains(string_view haystack, string_view needle) {
+                if (needle.empty()) return true;
+                if (needle.length() > haystack.length()) return false;
+                for (size_t position = 0; position + needle.length() <= haystack.length(); ++position) {
+                    if (needle.length() < 3 && position > 0 && haystack[position - 1] != ' ') continue;
+                    if (equal(needle.begin(), needle.end(), haystack.begin() + position,
+                        [](char a, char b) { return toLower(a) == toLower(b); })) return true;
+                }
+                return false;
+            }
+
+        private:
+            vector<unsigned short> paths{};         // Paths of all entries back to back
+            vector<size_t> pathOffsets{ 0 };        // Entry e's path is paths[pathOffsets[e], pathOffsets[e + 1])
+            unordered_map<uint32_t, vector<EntryId>> postings{}; // Sorted entries containing each trigram
+
+            static constexpr uint32_t trigram(char a, char b, char c) {
+                return
+                    (static_cast<uint32_t>(static_cast<unsigned char>(toLower(a))) << 16) |
+                    (static_cast<uint32_t>(static_cast<unsigned char>(toLower(b))) << 8) |
+                    static_cast<uint32_t>(static_cast<unsigned char>(toLower(c)));
+            }
+
+            // Briefs are indexed as if preceded by a space so that the first word starts a trigram too
+            template <typename F>
+            static void forEachIndexTrigram(string_view brief, F&& f) {
+                if (brief.length() < 2) return;
+                f(trigram(' ', brief[0], brief[1]));
+                for (size_t position = 0; position + 3 <= brief.length(); ++position) {
+                    f(trigram(brief[position], brief[position + 1], brief[position + 2]));
+                }
+            }
+
+            // A two character query looks for the start of a word
+            template <typename F>
+            static void forEachQueryTrigram(string_view query, F&& f) {
+                if (query.length() < 3) {
+                    f(trigram(' ', query[0], query[1]));
+                    return;
+                }
+                for (size_t position = 0; position + 3 <= query.length(); ++position) {
+                    f(trigram(query[position], query[position + 1], query[position + 2]));
+                }
+            }
+    };
+}
@@ -0,0 +1,246 @@
+#pragma once
+/*********************************************************************
+ * @file  menuServer.h
+ *
+ * @brief Class BasicMenuServer which serves one menu tree to many sessions
+ *        over a local Unix socket (Linux only)
+ *
+ *********************************************************************/
+
+#include "consoleMenu.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace consoleMenu {
+    using std::streambuf;
+    using std::system_error;
+    using std::generic_category;
+}
+
+namespace consoleMenu {
+
+    /**
+    * Stream buffer which sends what is written to it over a non blocking socket when it is
+    * flushed or full. Output the socket cannot take yet is kept, and onBlocked is called so its
+    * owner can wait for the socket to become writable and call sendPending.
+    * A peer which has gone away, or leaves more than MAX_PENDING bytes unread, makes the stream
+    * fail and the socket shut down, instead of raising SIGPIPE or holding on to ever more output.
+    */
+    class SocketOutputBuffer : public streambuf {
+        public:
+            static constexpr size_t MAX_PENDING = size_t{ 1 } << 20;
+
+            explicit SocketOutputBuffer(int fd) : fd{ fd } { setp(buffer, buffer + sizeof(buffer)); }
+
+            function<void()> onBlocked{}; //!< Called when output starts waiting for the socket
+
+            // Sends as much kept output as the socket takes now; false once the stream has failed
+            bool sendPending() {
+                pending.erase(0, sendSome(pending));
+                return !failed;
+            }
+
+            bool hasPending() const { return !pending.empty(); }
+
+        protected:
+            int_type overflow(int_type c) override {
+                if (!sendWritten()) return traits_type::eof();
+                if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                    *pptr() = traits_type::to_char_type(c);
+                    pbump(1);
+                }
+                return traits_type::not_eof(c);
+            }
+
+            int sync() override { return sendWritten() ? 0 : -1; }
+
+        private:
+            int fd;
+            char buffer[4096];
+            string pending{}; // Output the socket has not taken yet, oldest first
+            bool failed{ false };
+
+            // Bytes of data the socket took before it would block
+            size_t sendSome(string_view data) {
+                size_t sent = 0;
+                while (!failed && sent < data.size()) {
+                    auto count = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL | MSG_DONTWAIT);
+                    if (count < 0 && EINTR == errno) continue;
+                    if (count < 0 && (EAGAIN == errno || EWOULDBLOCK == errno)) break;
+                    if (count <= 0) fail();
+                    else sent += static_cast<size_t>(count);
+                }
+                return sent;
+            }
+
+            // Sends what was written since the last call, behind any output which is still kept
+            bool sendWritten() {
+                string_view written{ pbase(), static_cast<size_t>(pptr() - pbase()) };
+                if (pending.empty()) written.remove_prefix(sendSome(written));
+                if (!failed && !written.empty()) {
+                    bool wasBlocked = !pending.empty();
+                    pending.append(written);
+                    if (pending.size() > MAX_PENDING) fail();
+                    else if (!wasBlocked && onBlocked) onBlocked();
+                }
+                setp(buffer, buffer + sizeof(buffer));
+                return !failed;
+            }
+
+            void fail() {
+                failed = true;
+                pending.clear();
+                ::shutdown(fd, SHUT_RDWR); // Ends the session's wait for input too
+            }
+    };
+
+    /**
+    * Accepts connections on a Unix socket and runs displayMenuAsync for each of them on one EventLoop.
+    * Every session navigates the tree of the served menu through a SharedMenuTree, with its own
+    * path, cursor and frame buffer; the viewport is copied from the served menu when it connects.
+    *
+    * Sessions share the layout caches of the tree, which is safe because they all run on the
+    * loop's thread. The served menu must not be changed while the server runs.
+    * Session sockets are non blocking: output a client does not read yet waits in its session
+    * while the others go on, and a client which falls more than SocketOutputBuffer::MAX_PENDING
+    * bytes behind is disconnected.
+    * A session is closed and freed on the loop turn after it ends, without waiting for another connection.
+    */
+    template <class Tree>
+    class BasicMenuServer {
+        public:
+            using SessionMenu = BasicMenu<SharedMenuTree<Tree>>;
+
+            // Starts listening on socketPath, which must not exist yet
+            BasicMenuServer(shared_ptr<BasicMenu<Tree>> servedMenu, osUtils::EventLoop& loop, string socketPath) :
+                servedMenu{ std::move(servedMenu) }, loop{ loop }, socketPath{ std::move(socketPath) } {
+                sockaddr_un address{};
+                address.sun_family = AF_UNIX;
+                if (this->socketPath.size() >= sizeof(address.sun_path)) throw "Socket path is too long for a Unix socket";
+                std::memcpy(address.sun_path, this->socketPath.data(), this->socketPath.size());
+
+                listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (listenFd < 0) throw system_error(errno, generic_category(), "socket");
+                if (0 != ::bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) ||
+                    0 != ::listen(listenFd, SOMAXCONN)) {
+                    auto error = errno;
+                    ::close(listenFd);
+                    throw system_error(error, generic_category(), "bind");
+                }
+                sessionEndedFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (sessionEndedFd < 0) {
+                    auto error = errno;
+                    ::close(listenFd);
+                    throw system_error(error, generic_category(), "eventfd");
+                }
+                acceptTask.emplace(acceptSessions());
+                reapTask.emplace(reapSessions());
+            }
+
+            // Ends every session and removes the socket
+            ~BasicMenuServer() {
+                acceptTask.reset();
+                reapTask.reset();
+                sessions.clear();
+                ::close(sessionEndedFd);
+                ::close(listenFd);
+                ::unlink(socketPath.c_str());
+            }
+
+            BasicMenuServer(const BasicMenuServer&) = delete;
+            BasicMenuServer& operator=(const BasicMenuServer&) = delete;
+
+            // Sessions which have not been closed yet; one which ended is closed on the next loop turn
+            size_t sessionCount() const { return sessions.size(); }
+
+        private:
+            struct Session {
+                Session(int fd, SharedMenuTree<Tree> tree) : fd{ fd }, output{ fd }, os{ &output }, menu{ std::move(tree) } {}
+                ~Session() {
+                    // The tasks use the other members
+                    task.reset();
+                    writer.reset();
+                    ::close(fd);
+                }
+
+                int fd;
+                SocketOutputBuffer output;
+                ostream os;
+                SessionMenu menu;
+                optional<osUtils::Task> task{};
+                optional<osUtils::Task> writer{}; // Sends kept output as the socket takes it
+            };
+
+            shared_ptr<BasicMenu<Tree>> servedMenu;
+            osUtils::EventLoop& loop;
+            string socketPath;
+            int listenFd{ -1 };
+            int sessionEndedFd{ -1 }; // eventfd which serveSession signals as it ends
+            list<unique_ptr<Session>> sessions{}; // Tasks refer to their session, so sessions must not move
+            optional<osUtils::Task> acceptTask{};
+            optional<osUtils::Task> reapTask{};
+
+            osUtils::Task acceptSessions() {
+                while (true) {
+                    co_await loop.readable(listenFd);
+
+                    // The listening socket is non blocking, so this accepts every waiting connection
+                    while (true) {
+                        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                        if (fd < 0) {
+                            if (EINTR == errno) continue;
+                            break;
+                        }
+                        auto& session = *sessions.emplace_back(make_unique<Session>(fd, shareMenuTree(servedMenu)));
+                        session.menu.viewport = servedMenu->viewport;
+                        session.menu.viewport.start = 0;
+                        session.output.onBlocked = [this, &session]() { session.writer.emplace(sendKeptOutput(session)); };
+                        session.task.emplace(serveSession(session));
+                    }
+                }
+            }
+
+            osUtils::Task serveSession(Session& session) {
+                co_await session.menu.displayMenuAsync(loop, session.fd, session.os);
+                if (session.writer && !session.writer->done()) co_await *session.writer;
+                // Lets the client see the end of the session before the socket is closed
+                ::shutdown(session.fd, SHUT_RDWR);
+                ::eventfd_write(sessionEndedFd, 1);
+            }
+
+            // Frees ended sessions, which cannot free themselves while their task is still running
+            osUtils::Task reapSessions() {
+                while (true) {
+                    co_await loop.readable(sessionEndedFd);
+                    eventfd_t ended = 0;
+                    ::eventfd_read(sessionEndedFd, &ended);
+                    // Resumed by the loop, so every task which signalled has finished by now
+                    sessions.remove_if([](const unique_ptr<Session>& session) { return session->task->done(); });
+                }
+            }
+
+            // Runs from when output is first kept until the socket has taken all of it or failed
+            osUtils::Task sendKeptOutput(Session& session) {
+                do {
+                    co_await loop.writable(session.fd);
+                } while (session.output.sendPending() && session.output.hasPending());
+            }
+    };
+
+    using MenuServer = BasicMenuServer<MenuNodeTree>;
+    using PooledMenuServer = BasicMenuServer<MenuNodePool>;
+}
+
+#endif
@@ -0,0 +1,208 @@
+#pragma once
+/*********************************************************************
+ * @file  menuSnapshot.h
+ *
+ * @brief Immutable, versioned menu trees which background threads can
+ *        extend while menus are being displayed
+ *
+ *********************************************************************/
+
+#include "consoleMenu.h"
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+
+namespace consoleMenu {
+    using std::atomic;
+    using std::make_shared;
+    using std::memory_order_acquire;
+    using std::memory_order_acq_rel;
+    using std::memory_order_release;
+}
+
+namespace consoleMenu {
+
+    /**
+    * Node of one published version of a menu tree. It is never changed once published,
+    * and versions share every subtree which a change did not touch.
+    * The brief is laid out for the node's position when the node is built, so rendering only reads.
+    */
+    struct SnapshotNode {
+        MenuContents contents{};
+        MenuSettings settings{};
+        string briefLayout{};
+        vector<shared_ptr<const SnapshotNode>> children{};
+    };
+
+    /**
+    * Latest version of a menu tree.
+    * Writers on any thread publish a new version by copying the nodes from the root to the change;
+    * readers take the latest version with one atomic load and keep it alive for as long as they hold it.
+    * Readers never wait for a writer to finish building a version, but atomic<shared_ptr> is not
+    * lock free in every standard library (libstdc++ guards it with a short internal lock), so a load
+    * can briefly wait on another load or publish of the root. A version number which is lock free
+    * everywhere lets readers check for a new version without touching the root at all.
+    *
+    * Each copied node brings its contents, layout and whole child vector along, so adding a child
+    * costs O(depth * fan-out) pointer copies and suits menus which grow by a few nodes at a time.
+    */
+    class MenuSnapshots {
+        public:
+            using NodePtr = shared_ptr<const SnapshotNode>;
+
+            MenuSnapshots() : latestRoot{ make_shared<const SnapshotNode>(SnapshotNode{ MenuContents{{},{}}, ROOT_SETTINGS }) } {}
+
+            MenuSnapshots(const MenuSnapshots&) = delete;
+            MenuSnapshots& operator=(const MenuSnapshots&) = delete;
+
+            // Root of the latest version
+            NodePtr latest() const { return latestRoot.load(memory_order_acquire); }
+
+            // Number of versions published so far; it only goes up after the version it counts can be loaded
+            size_t version() const { return publishedVersion.load(memory_order_acquire); }
+
+            /**
+            * @brief publishes a version of the tree with a child added after the children of the node at path
+            *
+            * If another writer publishes first, the change is made again on top of that version.
+            *
+            * @return index of the new child; empty if there is no node at path
+            */
+            optional<unsigned short> addChild(
+                span<const unsigned short> path,
+                const MenuContents& contents,
+                const MenuSettings& settings = MenuSettings{}
+            ) {
+                auto current = latest();
+                while (true) {
+                    unsigned short childIndex = 0;
+                    auto updated = withChildAdded(*current, path, contents, settings, childIndex);
+                    if (!updated) return {};
+                    if (latestRoot.compare_exchange_weak(current, std::move(updated), memory_order_acq_rel, memory_order_acquire)) {
+                        publishedVersion.fetch_add(1, memory_order_release);
+                        return childIndex;
+                    }
+                }
+            }
+
+        private:
+            atomic<NodePtr> latestRoot;
+            atomic<size_t> publishedVersion{ 0 };
+            static_assert(atomic<size_t>::is_always_lock_free);
+
+            static NodePtr withChildAdded(
+                const SnapshotNode& node,
+                span<const unsigned short> path,
+                const MenuContents& contents,
+                const MenuSettings& settings,
+                unsigned short& childIndex
+            ) {
+                if (path.empty()) {
+                    if (node.children.size() >= numeric_limits<unsigned short>::max()) throw TOO_MANY_CHILDREN_ERROR;
+                    childIndex = static_cast<unsigned short>(node.children.size());
+                    auto copy = make_shared<SnapshotNode>(node);
+                    copy->children.push_back(makeNode(contents, settings, childIndex + size_t{ 1 }, node.settings.spaceAfterBullet));
+                    return copy;
+                }
+                if (path[0] >= node.children.size()) return {};
+                auto child = withChildAdded(*node.children[path[0]], path.subspan(1), contents, settings, childIndex);
+                if (!child) return {};
+                auto copy = make_shared<SnapshotNode>(node);
+                copy->children[path[0]] = std::move(child);
+                return copy;
+            }
+
+            static NodePtr makeNode(const MenuContents& contents, const MenuSettings& settings, size_t itemNum, unsigned short spaceAfterBullet) {
+                ostringstream laidOut{};
+                MenuContents::addItem(laidOut, contents.brief, settings.briefIndentSpaces, settings.maxLineLength, bulletString(itemNum, spaceAfterBullet));
+                return make_shared<const SnapshotNode>(SnapshotNode{ contents, settings, std::move(laidOut).str() });
+            }
+    };
+
+    /**
+    * Tree storage which reads the version of a MenuSnapshots tree it last pinned.
+    * Nodes are added through MenuSnapshots::addChild, from any thread; BasicMenu::refreshTree
+    * moves a menu to the latest version, and applying a user option does so first.
+    * Each menu needs its own SnapshotMenuTree, but many of them can read the same MenuSnapshots.
+    */
+    class SnapshotMenuTree {
+        public:
+            using NodeRef = const SnapshotNode*; // Valid while the version it belongs to is pinned
+            using optionalNodeRef = optional<NodeRef>;
+
+            SnapshotMenuTree() : SnapshotMenuTree(make_shared<MenuSnapshots>()) {}
+            explicit SnapshotMenuTree(shared_ptr<MenuSnapshots> snapshots) :
+                snapshots{ std::move(snapshots) }, pinnedVersion{ this->snapshots->version() }, pinnedRoot{ this->snapshots->latest() } {}
+
+            MenuSnapshots& source() const { return *snapshots; }
+
+            // Pins the latest version; false if it is the one already pinned
+            bool refresh() {
+                auto version = snapshots->version();
+                if (version == pinnedVersion) return false; // Only a lock free load while nothing is published
+                pinnedVersion = version;
+                auto latest = snapshots->latest();
+                if (latest == pinnedRoot) return false;
+                pinnedRoot = std::move(latest);
+                return true;
+            }
+
+            NodeRef rootNode() const { return pinnedRoot.get(); }
+
+            size_t childCount(NodeRef node) const { return node->children.size(); }
+
+            const MenuContents& contents(NodeRef node) const { return node->contents; }
+
+            // Children are only ever added by publishing a new version
+            bool expand(NodeRef) { return false; }
+            bool isExpandable(NodeRef) const { return false; }
+            void collapse(NodeRef) {}
+
+            optionalNodeRef childAt(NodeRef node, size_t index) const {
+                if (index >= node->children.size()) return {};
+                return { node->children[index].get() };
+            }
+
+            template <typename F>
+            void forEachChild(NodeRef node, F&& f) const {
+                for (auto& child : node->children) f(child.get());
+            }
+
+            optionalNodeRef nodeAtRelativePath(NodeRef node, span<const unsigned short> relativePath) const {
+                for (auto index : relativePath) {
+                    if (index >= node->children.size()) return {};
+                    node = node->children[index].get();
+                }
+                return { node };
+            }
+
+            // Every brief comes laid out already, so each one counts as a layout cache hit
+            string& appendBriefsAlongPath(
+                string& frame,
+                NodeRef node,
+                span<const unsigned short> path,
+                const Viewport& viewport
+            ) const {
+                auto& children = node->children;
+                auto [first, last] = viewport.window(children.size(), path.empty() ? viewport.start : path[0]);
+                for (auto index = first; index < last; ++index) {
+                    auto& child = *children[index];
+                    if (child.settings.hidden) continue;
+                    ++layoutCacheStats.hits;
+                    frame += child.briefLayout;
+                    if (!path.empty() && index == path[0]) appendBriefsAlongPath(frame, &child, path.subspan(1), viewport);
+                }
+                return Viewport::appendPageIndicator(frame, first, last, children.size());
+            }
+
+            mutable LayoutCacheStats layoutCacheStats{};
+
+        private:
+            shared_ptr<MenuSnapshots> snapshots;
+            size_t pinnedVersion;                      // May lag pinnedRoot, which costs one extra load of the root
+            shared_ptr<const SnapshotNode> pinnedRoot; // Keeps the pinned version alive
+    };
+
+    using SnapshotMenu = BasicMenu<SnapshotMenuTree>;
+}
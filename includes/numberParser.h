@@ -0,0 +1,59 @@
+#pragma once
+/*********************************************************************
+ * @file  numberParser.h
+ *
+ * @brief Non throwing single pass parsing of numbers from input tokens
+ *
+ *********************************************************************/
+
+#include "integerString.h"
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+namespace ioUtils {
+    using std::from_chars;
+    using std::optional;
+    using std::string_view;
+    using std::is_same_v;
+    using std::is_unsigned_v;
+    using std::is_integral_v;
+    using std::is_floating_point_v;
+}
+
+namespace ioUtils {
+
+    /**
+    * @brief parses a whole token as a T with one std::from_chars pass, without allocating or throwing
+    *
+    * A leading '+' is accepted; unsigned types reject any '-'.
+    * Floating point tokens may use the fixed or scientific format.
+    * An IntegerString is only checked digit by digit when the token does not fit in a long long.
+    *
+    * @param token the number and nothing else
+    * @return the number; empty if token is not a T or is out of the range of T
+    */
+    template <typename T>
+        requires is_integral_v<T> || is_floating_point_v<T> || is_same_v<T, IntegerString>
+    optional<T> parseNumber(string_view token) {
+        if constexpr (is_same_v<T, IntegerString>) {
+            if (!parseNumber<long long>(token) && !IntegerString::isInteger(token)) return {};
+            return IntegerString{ token };
+        } else {
+            if (!token.empty() && '+' == token[0]) {
+                token.remove_prefix(1);
+                if (!token.empty() && ('+' == token[0] || '-' == token[0])) return {};
+            }
+            if constexpr (is_unsigned_v<T>) {
+                if (!token.empty() && '-' == token[0]) return {};
+            }
+
+            T number{};
+            auto [end, error] = from_chars(token.data(), token.data() + token.size(), number);
+            if (error != std::errc{} || end != token.data() + token.size()) return {};
+            return number;
+        }
+    }
+}
@@ -5,11 +5,67 @@
  *
  *********************************************************************/
 
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
 namespace osUtils {
+    using std::ostream;
+    using std::string;
+    using std::size_t;
+}
+
+namespace osUtils {
+
+    enum class ClearMethod {
+        EscapeSequence, //!< Write ANSI clear and cursor home sequences to the output stream
+        SystemCommand   //!< Run "cls" or "clear" in a shell; only for consoles without ANSI support
+    };
+
+    /**
+    * @brief clears the console and moves the cursor to the top left corner
+    *
+    * @param os output stream of the console to clear
+    * @param method how to clear; ClearMethod::SystemCommand starts a shell on every call
+    * @return true if the console was cleared; false if the system command failed
+    */
+    bool clearScreen(ostream& os = std::cout, ClearMethod method = ClearMethod::EscapeSequence);
+
+    /**
+    * @brief returns if os writes to an interactive terminal
+    *
+    * On Windows this also enables ANSI escape sequence processing for the console.
+    *
+    * @param os output stream; only streams sharing a buffer with cout, cerr or clog can be terminals
+    * @return true if the file descriptor behind os is a terminal; false otherwise
+    */
+    bool isTerminal(const ostream& os);
+
+    /**
+    * @brief moves the terminal cursor with an ANSI escape sequence
+    *
+    * @param row 1 based row from the top of the screen
+    * @param column 1 based column from the start of the row
+    */
+    ostream& moveCursor(ostream& os, size_t row, size_t column);
+
+    /**
+    * Appends the escape sequence of moveCursor to a frame which is written out later
+    */
+    string& moveCursor(string& frame, size_t row, size_t column);
+
+    /**
+    * Erase from the cursor to the end of the line with an ANSI escape sequence
+    */
+    ostream& clearToEndOfLine(ostream& os);
+    string& clearToEndOfLine(string& frame);
 
     /**
-    * Clear console via a system command
+    * Erase from the cursor to the end of the screen with an ANSI escape sequence
     */
-    void clearScreen();
+    ostream& clearToEndOfScreen(ostream& os);
+    string& clearToEndOfScreen(string& frame);
 
-}
\ No newline at end of file
+}
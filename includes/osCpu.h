@@ -0,0 +1,32 @@
+/*********************************************************************
+ * @file  osCpu.h
+ *
+ * @brief Vector instruction sets the processor supports, checked at run
+ *        time, for the byte scanners in ioUtils and svUtils
+ *
+ *********************************************************************/
+
+#pragma once
+
+// Lets a translation unit compile AVX2 functions without building everything for AVX2
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define OS_CPU_X86
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define OS_CPU_TARGET_AVX2
+    #else
+        #define OS_CPU_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace osUtils {
+
+    // How a scanner classifies the bytes of each block, from slowest to fastest
+    enum class ScanPath {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Fastest path the processor supports; checked once
+    ScanPath bestScanPath();
+}
@@ -0,0 +1,194 @@
+/*********************************************************************
+ * @file  osEventLoop.h
+ *
+ * @brief Single threaded epoll event loop which resumes C++20 coroutines
+ *        when a file descriptor becomes readable or writable or a timer
+ *        expires (Linux only)
+ *
+ *********************************************************************/
+
+#pragma once
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace osUtils {
+    using std::coroutine_handle;
+    using std::suspend_always;
+    using std::suspend_never;
+    using std::noop_coroutine;
+    using std::exception_ptr;
+    using std::multimap;
+    using std::unordered_map;
+    using std::vector;
+    using steadyClock = std::chrono::steady_clock;
+}
+
+namespace osUtils {
+
+    /**
+    * Coroutine which starts running as soon as it is called and is resumed by an EventLoop.
+    * Another coroutine can co_await a Task to continue once it has finished.
+    * Destroying a Task which has not finished destroys its frame and cancels the wait it is in.
+    */
+    class Task {
+        public:
+            struct promise_type {
+                exception_ptr exception{};
+                coroutine_handle<> continuation{}; //!< Coroutine awaiting this one
+
+                // Resumes the awaiting coroutine, if any, once the body is done
+                struct FinalAwaiter {
+                    bool await_ready() const noexcept { return false; }
+                    coroutine_handle<> await_suspend(coroutine_handle<promise_type> handle) noexcept {
+                        auto continuation = handle.promise().continuation;
+                        return continuation ? continuation : noop_coroutine();
+                    }
+                    void await_resume() const noexcept {}
+                };
+
+                Task get_return_object() { return Task{ coroutine_handle<promise_type>::from_promise(*this) }; }
+                suspend_never initial_suspend() noexcept { return {}; }
+                FinalAwaiter final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { exception = std::current_exception(); }
+            };
+
+            struct Awaiter {
+                const Task& task;
+                bool await_ready() const noexcept { return task.done(); }
+                void await_suspend(coroutine_handle<> awaiting) noexcept { task.handle.promise().continuation = awaiting; }
+                void await_resume() const { task.rethrowIfFailed(); }
+            };
+
+            // The task has to stay alive until the awaiting coroutine resumes
+            Awaiter operator co_await() const noexcept { return { *this }; }
+
+            Task(Task&& other) noexcept : handle{ other.handle } { other.handle = {}; }
+            Task& operator=(Task&& other) noexcept;
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+            ~Task() { if (handle) handle.destroy(); }
+
+            bool done() const { return !handle || handle.done(); }
+
+            // Rethrows an exception which ended the coroutine
+            void rethrowIfFailed() const {
+                if (handle && handle.promise().exception) std::rethrow_exception(handle.promise().exception);
+            }
+
+        private:
+            explicit Task(coroutine_handle<promise_type> handle) : handle{ handle } {}
+            coroutine_handle<promise_type> handle{};
+    };
+
+    /**
+    * Waits with one epoll_wait call for every registered file descriptor and the earliest timer,
+    * and resumes the coroutines whose wait is over. Timers need no file descriptor of their own.
+    * One coroutine can wait for a file descriptor to be readable while another waits for it to be writable.
+    * Regular files, which epoll refuses, are always ready: their waits end on the next runOnce.
+    */
+    class EventLoop {
+        public:
+            EventLoop();
+            ~EventLoop();
+            EventLoop(const EventLoop&) = delete;
+            EventLoop& operator=(const EventLoop&) = delete;
+
+            enum class Direction {
+                Read,
+                Write
+            };
+
+            class FdAwaiter {
+                public:
+                    FdAwaiter(EventLoop& loop, int fd, Direction direction) : loop{ loop }, fd{ fd }, direction{ direction } {}
+                    FdAwaiter(const FdAwaiter&) = delete;
+                    FdAwaiter& operator=(const FdAwaiter&) = delete;
+                    ~FdAwaiter() { if (waiting) loop.removeWaiter(fd, direction); }
+
+                    bool await_ready() const noexcept { return false; }
+                    void await_suspend(coroutine_handle<> handle);
+                    void await_resume() noexcept { waiting = false; }
+
+                private:
+                    EventLoop& loop;
+                    int fd;
+                    Direction direction;
+                    bool waiting{ false };
+            };
+
+            class TimerAwaiter {
+                public:
+                    TimerAwaiter(EventLoop& loop, steadyClock::time_point deadline) : loop{ loop }, deadline{ deadline } {}
+                    TimerAwaiter(const TimerAwaiter&) = delete;
+                    TimerAwaiter& operator=(const TimerAwaiter&) = delete;
+                    ~TimerAwaiter() { if (waiting) loop.removeTimer(timer); }
+
+                    bool await_ready() const noexcept { return deadline <= steadyClock::now(); }
+                    void await_suspend(coroutine_handle<> handle);
+                    void await_resume() noexcept { waiting = false; }
+
+                private:
+                    EventLoop& loop;
+                    steadyClock::time_point deadline;
+                    multimap<steadyClock::time_point, coroutine_handle<>>::iterator timer{};
+                    bool waiting{ false };
+            };
+
+            // co_await loop.readable(fd) resumes once fd has data, is closed or failed
+            FdAwaiter readable(int fd) { return { *this, fd, Direction::Read }; }
+
+            // co_await loop.writable(fd) resumes once fd can take more output, is closed or failed
+            FdAwaiter writable(int fd) { return { *this, fd, Direction::Write }; }
+
+            // co_await loop.sleepFor(duration) resumes once duration has passed
+            template <class Rep, class Period>
+            TimerAwaiter sleepFor(std::chrono::duration<Rep, Period> duration) {
+                return { *this, steadyClock::now() + std::chrono::duration_cast<steadyClock::duration>(duration) };
+            }
+
+            /**
+            * @brief waits for the next events and resumes their coroutines
+            *
+            * @param timeout longest time to wait; negative waits until an event arrives
+            * @return false if nothing is waiting on the loop any more
+            */
+            bool runOnce(std::chrono::milliseconds timeout = std::chrono::milliseconds{ -1 });
+
+            // Runs until nothing is waiting or stop() is called
+            void run();
+
+            void stop() { stopped = true; }
+
+            bool hasWaiters() const { return !fdWaiters.empty() || !timers.empty(); }
+
+        private:
+            // Coroutines waiting on one file descriptor; epoll watches it for the events of both
+            struct FdWaiters {
+                coroutine_handle<> reader{};
+                coroutine_handle<> writer{};
+                bool alwaysReady{ false }; //!< Not registered with epoll, which does not support the fd
+            };
+
+            int epollFd{ -1 };
+            bool stopped{ false };
+            unordered_map<int, FdWaiters> fdWaiters{};
+            vector<int> alwaysReadyFds{};
+            multimap<steadyClock::time_point, coroutine_handle<>> timers{};
+
+            void addWaiter(int fd, Direction direction, coroutine_handle<> handle);
+            void removeWaiter(int fd, Direction direction);
+            void resumeWaiter(int fd, Direction direction);
+            void removeTimer(multimap<steadyClock::time_point, coroutine_handle<>>::iterator timer) { timers.erase(timer); }
+    };
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*********************************************************************
+ * @file  osKeyboard.h
+ *
+ * @brief Single keystroke input from the OS specific console
+ *
+ *********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace osUtils {
+    using std::size_t;
+    using std::string_view;
+}
+
+namespace osUtils {
+
+    enum class Key {
+        None,       //!< Bytes which are not a key this module knows about
+        Character,  //!< A printable character or digit; see KeyPress::character
+        Enter,
+        Backspace,
+        Escape,
+        Up,
+        Down,
+        Left,
+        Right,
+        Home,
+        End,
+        EndOfInput  //!< The input was closed or Ctrl-D was pressed
+    };
+
+    struct KeyPress {
+        Key key{ Key::None };
+        char character{ 0 };
+        bool operator==(const KeyPress& other) const = default;
+    };
+
+    /**
+    * @brief decodes the first key of bytes read from a terminal in raw mode
+    *
+    * Understands single characters and the VT100/xterm sequences for arrows, Home and End.
+    * ESC followed by another character, as terminals send Alt with a key, is one Key::None.
+    *
+    * @param bytes input read so far
+    * @param keyPress set to the decoded key
+    * @return bytes used by the key; 0 if bytes is empty or ends inside an escape sequence
+    */
+    size_t decodeKey(string_view bytes, KeyPress& keyPress);
+
+    /**
+    * Puts a terminal into non canonical mode without echo for as long as it lives.
+    * The previous terminal state is restored by the destructor, at exit and when
+    * the process is stopped by SIGINT, SIGTERM, SIGHUP or SIGQUIT.
+    * Only one RawTerminal should be alive at a time.
+    */
+    class RawTerminal {
+        public:
+            explicit RawTerminal(int fd = 0);
+            ~RawTerminal();
+
+            RawTerminal(const RawTerminal&) = delete;
+            RawTerminal& operator=(const RawTerminal&) = delete;
+
+            // False if fd is not a terminal; keys can not be read then
+            bool isActive() const { return active; }
+
+            // Blocks until a whole key was read
+            KeyPress readKey();
+
+        private:
+            int fd;
+            bool active{ false };
+            char pending[16]{};
+            size_t pendingCount{ 0 };
+
+            bool readMore(int timeoutMilliseconds);
+    };
+
+}
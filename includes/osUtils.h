@@ -1,3 +1,6 @@
 #pragma once
 #include "osName.h"
 #include "osConsole.h"
+#include "osKeyboard.h"
+#include "osEventLoop.h"
+#include "osCpu.h"
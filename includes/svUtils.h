@@ -1,11 +1,18 @@
 #pragma once
+#include "osCpu.h"
+#include <string>
 #include <string_view>
 #include <iostream>
 #include <tuple>
+#include <vector>
 
 namespace svUtils {
+    using std::string;
     using std::string_view;
     using std::ostream;
+    using std::vector;
+    using osUtils::ScanPath;
+    using osUtils::bestScanPath;
     template< class... Types >
     using tuple = std::tuple<Types ...>;
 }
@@ -24,12 +31,59 @@ namespace svUtils{
 
     SVSplit splitByPosition(string_view sv, size_t pos);
     SVSplit splitByDelimiter(string_view sv, const string_view delimiter = " ");
+
+    // Positions scanDelimiters found in a text
+    struct DelimiterPositions {
+        vector<size_t> delimiters{}; //!< Every position a match of the delimiter starts at, overlapping matches included
+        vector<size_t> newLines{};
+    };
+
+    /**
+    * @brief finds every match of delimiter and every '\n' in text
+    *
+    * The first byte of the delimiter and '\n' are compared with a block of 64 bytes at once;
+    * a longer delimiter is then compared where its first byte was found. An empty delimiter
+    * matches at every position.
+    *
+    * @param positions replaced by the positions in increasing order; its capacity is reused
+    * @param path how the bytes of each block are compared; a path the processor does not support falls back to bestScanPath()
+    */
+    void scanDelimiters(string_view text, string_view delimiter, DelimiterPositions& positions, ScanPath path = bestScanPath());
+
+    // Whether every byte of text is below 0x80; checks 64 bytes at a time
+    bool isAscii(string_view text);
+
+    /**
+    * @brief columns a terminal gives a code point: 0 for combining marks and other zero width
+    *        characters, 2 for East Asian wide and fullwidth characters, 1 for everything else
+    */
+    size_t codePointWidth(char32_t codePoint);
+
+    // Columns of UTF-8 text; every byte which is not part of a valid sequence counts as one column
+    size_t displayWidth(string_view text);
    
 
+    /**
+    * @brief writes lines to os wrapped at lineOptions.maxLineLength, indenting every line after the first
+    *
+    * Lines break after a delimiter where possible, words longer than a line are split and
+    * every '\n' starts a new line. Delimiters and newlines are found with scanDelimiters,
+    * 64 KiB of lines at a time, and the output is written in blocks.
+    * Lengths are display columns of UTF-8 text: a word is only split between code points,
+    * and combining marks stay on the line of the character they follow. Text which is all
+    * ASCII, checked 64 bytes at a time, is measured in bytes without decoding.
+    */
     void wrapToLength(
         ostream& os, 
         string_view lines, 
         const LineOptions& lineOptions = {}
     );
+
+    // wrapToLength appending to output instead of writing to a stream
+    void wrapToLength(
+        string& output,
+        string_view lines,
+        const LineOptions& lineOptions = {}
+    );
     
 }
\ No newline at end of file
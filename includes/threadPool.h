@@ -0,0 +1,85 @@
+#pragma once
+/*********************************************************************
+ * @file  threadPool.h
+ *
+ * @brief Worker threads which split the indices of a loop between them,
+ *        for laying out whole menus at load time
+ *
+ *********************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace consoleMenu {
+    using std::atomic;
+    using std::condition_variable;
+    using std::exception_ptr;
+    using std::function;
+    using std::mutex;
+    using std::thread;
+    using std::vector;
+}
+
+namespace consoleMenu {
+
+    /**
+    * Threads kept waiting between loops so each loop only pays for a wake up.
+    * The thread calling forEachIndex works on the loop too, so a pool of one thread starts no worker.
+    */
+    class ThreadPool {
+        public:
+            explicit ThreadPool(size_t threadCount = thread::hardware_concurrency());
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            // Threads working on a loop, counting the caller
+            size_t size() const { return workers.size() + 1; }
+
+            /**
+            * @brief calls f(index) for every index in [0, count), in chunks spread over the threads of the pool
+            *
+            * Returns once every call has returned; the first exception thrown by f is rethrown here.
+            * Calls for different indices may run at the same time, so f must only write state owned by its index.
+            */
+            template <typename F>
+            void forEachIndex(size_t count, F&& f) {
+                if (0 == count) return;
+                Loop loop{ count, [&f](size_t begin, size_t end) {
+                    for (auto index = begin; index < end; ++index) f(index);
+                } };
+                run(loop);
+            }
+
+        private:
+            struct Loop {
+                Loop(size_t count, function<void(size_t, size_t)> body) : count{ count }, body{ std::move(body) } {}
+
+                size_t count;
+                function<void(size_t, size_t)> body; // Called for each chunk [begin, end)
+                size_t chunkSize{ 1 };
+                atomic<size_t> next{ 0 };
+                exception_ptr error{};                // Guarded by the pool's mutex
+            };
+
+            void run(Loop& loop);
+            void work(Loop& loop);
+            void workerLoop();
+
+            vector<thread> workers{};
+            mutex loopMutex{};
+            condition_variable loopStarted{};
+            condition_variable loopFinished{};
+            Loop* currentLoop{ nullptr };  // Set while a loop runs; workers join it only then
+            size_t loopNumber{ 0 };        // Tells workers a new loop started since they last looked
+            size_t busyWorkers{ 0 };
+            bool stopping{ false };
+    };
+}
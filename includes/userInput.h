@@ -1,11 +1,13 @@
 #pragma once
 #include "integerString.h"
+#include "inputSource.h"
 #include <iostream> 
 #include <string_view> 
 #include <type_traits>
 #include <functional> 
-#include <tuple> 
 #include <optional> 
+#include <concepts> 
+#include <string> 
 
 namespace ioUtils {
     using std::cin;
@@ -15,12 +17,13 @@ namespace ioUtils {
     using std::string_view;
     using std::is_default_constructible_v;
     using std::function;
-    using std::apply;
-    using std::tuple;
-    using std::make_tuple;
-    using std::tuple_cat;
     using std::optional;
     using std::make_optional;
+    using std::string;
+    using std::invocable;
+    using std::predicate;
+    using std::invoke_result_t;
+    using std::remove_cvref_t;
 }
 
 namespace ioUtils {
@@ -34,92 +37,146 @@ namespace ioUtils {
     void resetInputStream(istream& is);
     
     function<bool(string_view)> isAlwaysValidInput();
+
+    // Buffer every getValidInput call on a thread reads its tokens into, so its capacity is reused
+    string& inputTokenBuffer();
+
+    // How much input the template getValidInput hands to its stages at a time
+    enum class InputExtent {
+        Token, //!< One whitespace separated token; the rest of its line is ignored
+        Line   //!< A whole line, which the stages may split themselves
+    };
     template <class T>
     function<bool(const T&)> isAlwaysValidOutput(){ 
         return [](const T& t) {return true;}; 
     };
     
+    template <typename F>
+    concept InputPrinter = invocable<F&, ostream&>;
+
+    template <typename F>
+    concept InputValidator = predicate<F&, string_view>;
+
+    template <typename F>
+    concept InputConverter = invocable<F&, string_view> &&
+        is_default_constructible_v<remove_cvref_t<invoke_result_t<F&, string_view>>>;
+
+    template <typename F>
+    using ConvertedInput = remove_cvref_t<invoke_result_t<F&, string_view>>;
+
+    template <typename F, typename T>
+    concept OutputValidator = predicate<F&, const T&>;
+
+    /**
+    * @brief reads tokens from source until one passes isValidInput, converts and passes isValidOutput
+    *
+    * The stages are template parameters, so they are called directly and can be inlined.
+    * Each token, or each line with InputExtent::Line, is handed to the stages as a string_view
+    * into the source, so it is not copied.
+    * A stage that throws rejects the token like a stage that returns false.
+    *
+    * @return the converted output; empty if the input ended before a valid token was read
+    */
     template <
-        typename T,
-        typename... InputValidationArgTypes,
-        typename... ConversionArgTypes,
-        typename... OutputValidationArgTypes
+        InputPrinter PrintPrompt,
+        InputPrinter PrintInvalidInputMessage,
+        InputPrinter PrintErrorMessage,
+        InputValidator IsValidInput,
+        InputConverter ConvertStringToOutput,
+        OutputValidator<ConvertedInput<ConvertStringToOutput>> IsValidOutput,
+        InputSource Source
     >
-        requires std::is_default_constructible_v<T>
-    optional<T> getValidInput(
-        function<void(ostream&)> printPrompt,
-        function<void(ostream&)> printInvalidInputMessage,
-        function<void(ostream&)> printErrorMessage,
-        function<bool(string_view, InputValidationArgTypes...)> isValidInput,
-        tuple<InputValidationArgTypes...> inputValidationArgs,
-        function<T(string_view, ConversionArgTypes...)> convertStringToOutput,
-        tuple<ConversionArgTypes...> conversionArgs,
-        function<bool(const T&, OutputValidationArgTypes...)> isValidOutput,
-        tuple<OutputValidationArgTypes...> outputValidationArgs,
-        istream& is = cin,
-        ostream& os = cout
+    optional<ConvertedInput<ConvertStringToOutput>> getValidInput(
+        PrintPrompt&& printPrompt,
+        PrintInvalidInputMessage&& printInvalidInputMessage,
+        PrintErrorMessage&& printErrorMessage,
+        IsValidInput&& isValidInput,
+        ConvertStringToOutput&& convertStringToOutput,
+        IsValidOutput&& isValidOutput,
+        Source& source,
+        ostream& os = cout,
+        InputExtent extent = InputExtent::Token
     ){
-    
-        auto printInvalidInputAndRepeatPrompt =
-            [
-                &printInvalidInputMessage, 
-                &printPrompt
-            ](ostream& os) -> void{
-                printInvalidInputMessage(os);
-                printPrompt(os);
+        auto rejectInput = [&source, &os, &printInvalidInputMessage, &printPrompt, extent]() {
+            if (InputExtent::Token == extent) source.skipLine(); // A rejected line was read in full already
+            printInvalidInputMessage(os);
+            printPrompt(os);
         };
 
         // Prompt the User for Input
         printPrompt(os);
 
-        T output{};
-        string inputString{};
-        while (hasUnextractedInput(is)) // Loop until user enters a valid input
+        while (source.hasUnextractedInput()) // Loop until user enters a valid input
         {
-            is >> inputString;
+            auto read = InputExtent::Line == extent ? source.readLine() : source.readToken();
 
-            if (!is) { // If the previous extraction failed
-                resetInputStream(is);
-                printInvalidInputAndRepeatPrompt(os);
+            if (!read) { // If the previous extraction failed
+                rejectInput();
                 continue;
             }
 
+            string_view input{ *read };
             try {
-                // Validate Input String
-                auto inputValidationAllArgs = tuple_cat(make_tuple(inputString), inputValidationArgs);
-                if (!apply(isValidInput, inputValidationAllArgs)) { // Invalid input
-                    resetInputStream(is);
-                    printInvalidInputAndRepeatPrompt(os);
+                if (!isValidInput(input)) {
+                    rejectInput();
                     continue;
                 }
 
-                // Convert to Output
-                auto conversionAllArgs = tuple_cat(make_tuple(inputString), conversionArgs);
-                output = apply(convertStringToOutput, conversionAllArgs);
-
-                // Validate Output
-                auto outputValidationAllArgs = tuple_cat(make_tuple(output), outputValidationArgs);
-                if (!apply(isValidOutput, outputValidationAllArgs)) { // Invalid input
-                    resetInputStream(is);
-                    printInvalidInputAndRepeatPrompt(os);
+                auto output = convertStringToOutput(input);
+                if (!isValidOutput(output)) {
+                    rejectInput();
                     continue;
                 }
+
+                // Ignore input line before returning 
+                if (InputExtent::Token == extent) source.skipLine();
+                return make_optional(std::move(output));
             }catch (...) {
-                resetInputStream(is);
-                printInvalidInputAndRepeatPrompt(os);
+                rejectInput();
                 continue;
             }
-
-            // Ignore input line before returning 
-            ignoreInputLine(is);
-            return make_optional(output);
         }
 
-
         printErrorMessage(os);
         return {};
     }
-    
+
+    /**
+    * @brief getValidInput reading from is through a StreamInputSource, into inputTokenBuffer()
+    */
+    template <
+        InputPrinter PrintPrompt,
+        InputPrinter PrintInvalidInputMessage,
+        InputPrinter PrintErrorMessage,
+        InputValidator IsValidInput,
+        InputConverter ConvertStringToOutput,
+        OutputValidator<ConvertedInput<ConvertStringToOutput>> IsValidOutput
+    >
+    optional<ConvertedInput<ConvertStringToOutput>> getValidInput(
+        PrintPrompt&& printPrompt,
+        PrintInvalidInputMessage&& printInvalidInputMessage,
+        PrintErrorMessage&& printErrorMessage,
+        IsValidInput&& isValidInput,
+        ConvertStringToOutput&& convertStringToOutput,
+        IsValidOutput&& isValidOutput,
+        istream& is = cin,
+        ostream& os = cout,
+        InputExtent extent = InputExtent::Token
+    ){
+        StreamInputSource source{ is };
+        return getValidInput(
+            std::forward<PrintPrompt>(printPrompt),
+            std::forward<PrintInvalidInputMessage>(printInvalidInputMessage),
+            std::forward<PrintErrorMessage>(printErrorMessage),
+            std::forward<IsValidInput>(isValidInput),
+            std::forward<ConvertStringToOutput>(convertStringToOutput),
+            std::forward<IsValidOutput>(isValidOutput),
+            source,
+            os,
+            extent
+        );
+    }
+
     template <typename T>
         //requires std::is_integral_v<T> || std::is_floating_point_v<T>
     optional<T> getNumberInRange(T lowerBound, T upperBound, string_view prompt, istream & is = cin, ostream& os = cout);
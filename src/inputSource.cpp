@@ -0,0 +1,132 @@
+#include "inputSource.h"
+#include "userInput.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <cerrno>
+    #include <unistd.h>
+#endif
+
+namespace ioUtils {
+    using std::string;
+}
+
+using namespace ioUtils;
+
+// Whitespace of the default locale, which operator>> skips and stops at
+static bool isWhitespace(char c) {
+    return ' ' == c || (c >= '\t' && c <= '\r');
+}
+
+bool StreamInputSource::hasUnextractedInput() {
+    return ioUtils::hasUnextractedInput(is);
+}
+
+optional<string_view> StreamInputSource::readToken() {
+    auto& token = inputTokenBuffer();
+    is >> token;
+    if (!is) return {};
+    return string_view{ token };
+}
+
+optional<string_view> StreamInputSource::readLine() {
+    auto& line = inputTokenBuffer();
+    std::getline(is, line);
+    if (!is) return {};
+    return string_view{ line };
+}
+
+void StreamInputSource::skipLine() {
+    resetInputStream(is);
+}
+
+FdInputSource::FdInputSource(int fd, size_t bufferSize) :
+    fd{ fd },
+    buffer(std::max<size_t>(bufferSize, 1)) {
+}
+
+bool FdInputSource::fill() {
+    if (endOfInput) return false;
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) buffer.resize(2 * buffer.size());
+
+    while (true) {
+        #if defined(_WIN32)
+            auto count = _read(fd, buffer.data() + end, static_cast<unsigned>(std::min<size_t>(buffer.size() - end, INT_MAX)));
+        #else
+            auto count = ::read(fd, buffer.data() + end, buffer.size() - end);
+            if (count < 0 && EINTR == errno) continue;
+        #endif
+        if (count > 0) {
+            end += static_cast<size_t>(count);
+            return true;
+        }
+        endOfInput = true; // End of file, or an error which ends the input like one
+        return false;
+    }
+}
+
+bool FdInputSource::hasUnextractedInput() {
+    if (begin == end && !fill()) return false;
+    return '\n' != buffer[begin];
+}
+
+optional<string_view> FdInputSource::readToken() {
+    while (true) {
+        auto start = std::find_if_not(buffer.data() + begin, buffer.data() + end, isWhitespace);
+        begin = static_cast<size_t>(start - buffer.data());
+        if (begin < end) break;
+        if (!fill()) return {};
+    }
+
+    // Offsets from begin stay valid when fill moves the unconsumed bytes
+    size_t length = 0;
+    while (true) {
+        auto stop = std::find_if(buffer.data() + begin + length, buffer.data() + end, isWhitespace);
+        length = static_cast<size_t>(stop - (buffer.data() + begin));
+        if (begin + length < end || !fill()) break;
+    }
+    string_view token{ buffer.data() + begin, length };
+    begin += length;
+    return token;
+}
+
+optional<string_view> FdInputSource::readLine() {
+    size_t searched = 0;
+    while (true) {
+        auto unsearched = unconsumed().substr(searched);
+        if (auto newline = unsearched.find('\n'); string_view::npos != newline) {
+            string_view line{ buffer.data() + begin, searched + newline };
+            begin += line.size() + 1;
+            return line;
+        }
+        searched += unsearched.size();
+        if (!fill()) break;
+    }
+
+    // Like getline, the last line needs no newline but an empty one fails
+    if (begin == end) return {};
+    auto line = unconsumed();
+    begin = end;
+    return line;
+}
+
+void FdInputSource::skipLine() {
+    while (true) {
+        if (auto newline = unconsumed().find('\n'); string_view::npos != newline) {
+            begin += newline + 1;
+            return;
+        }
+        begin = end;
+        if (!fill()) return;
+    }
+}
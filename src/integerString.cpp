@@ -1,5 +1,6 @@
 #include "integerString.h"
 
+#include <charconv>
 #include <iterator>
 #include <unordered_map>
 #include <stdexcept>
@@ -13,18 +14,20 @@ namespace ioUtils {
     using std::runtime_error;
     using std::abort;
     using std::ios;
-    using std::lexicographical_compare;
+    using std::to_chars;
+    using std::uint64_t;
 }
 
 using namespace ioUtils;
 
 IntegerString::DigitInString IntegerString::mostSignificantDigit(string_view integer) {
 
+    if (integer.empty()) return { 0, 0 };
     auto beg = integer.begin();
 
     // Check if starting character is '+' or '-' and move the beginning iteartor if that is the case
-    if (integer.at(0) == '+' || integer.at(0) == '-') {
-        beg = next(beg);
+    if (integer[0] == '+' || integer[0] == '-') {
+        beg = std::next(beg);
     }
 
     auto nonZeroDigitIterator =
@@ -60,54 +63,136 @@ string_view IntegerString::getAbsoluteValueString(string_view maybeInteger) {
     return removeSignAndLeadingZeros(maybeInteger);
 }
 
-bool IntegerString::operator < (const IntegerString& other) const {
-    if (&other == this) return false;
-    if (this->negative && !other.negative) return true;
-    if (!this->negative && other.negative) return false;
-    // Assumes that aString and bString are have only digits and no leading zeros
-    auto isnumberStringSmaller =
-        [](const string_view aString, const string_view bString) -> bool {
-        if (aString.empty() && bString.empty()) return false;
-        if (aString.length() < bString.length()) return true;
-        if (aString.length() > bString.length()) return false;
-        // Equal Lengths
-        return lexicographical_compare(
-            aString.begin(),
-            aString.end(),
-            bString.begin(),
-            bString.end(),
-            [](char a, char b) {
-            return charToDigit(a) < charToDigit(b);
-        }
-        );
+void IntegerString::reset(const string_view number) {
+    clear();
+    auto digits = getAbsoluteValueString(number);
+    if (digits.empty()) return;
+
+    // Groups of nine digits from the least significant end
+    limbs.reserve((digits.size() + LIMB_DIGITS - 1) / LIMB_DIGITS);
+    for (auto end = digits.size(); end > 0;) {
+        auto start = end > LIMB_DIGITS ? end - LIMB_DIGITS : 0;
+        uint32_t limb = 0;
+        for (auto index = start; index < end; ++index) limb = limb * 10 + static_cast<uint32_t>(digits[index] - '0');
+        limbs.push_back(limb);
+        end = start;
+    }
+    negative = isNegative(number);
+    normalize();
+}
+
+string IntegerString::toString() const {
+    string representation;
+    if (!valid()) return representation;
+    representation.reserve(limbs.size() * LIMB_DIGITS + 1);
+    if (negative) representation = '-';
+
+    char digits[LIMB_DIGITS];
+    auto appendLimb = [&representation, &digits](uint32_t limb, bool padded) {
+        auto end = to_chars(digits, digits + LIMB_DIGITS, limb).ptr;
+        auto length = static_cast<size_t>(end - digits);
+        if (padded) representation.append(LIMB_DIGITS - length, '0');
+        representation.append(digits, length);
     };
+    appendLimb(limbs.back(), false);
+    for (auto limb = std::next(limbs.rbegin()); limb != limbs.rend(); ++limb) appendLimb(*limb, true);
+    return representation;
+}
+
+int IntegerString::compareMagnitudes(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+    if (a.size() != b.size()) return a.size() < b.size() ? -1 : 1;
+    for (auto index = a.size(); index-- > 0;) {
+        if (a[index] != b[index]) return a[index] < b[index] ? -1 : 1;
+    }
+    return 0;
+}
 
-    if (this->negative && other.negative) return !isnumberStringSmaller(this->numberString, other.numberString);
-    //if (!this->negative && !other.negative) 
-    return isnumberStringSmaller(this->numberString, other.numberString);
+void IntegerString::addMagnitude(vector<uint32_t>& a, const vector<uint32_t>& b) {
+    if (a.size() < b.size()) a.resize(b.size(), 0);
+    uint32_t carry = 0;
+    for (size_t index = 0; index < a.size(); ++index) {
+        if (index >= b.size() && 0 == carry) return;
+        uint32_t sum = a[index] + (index < b.size() ? b[index] : 0) + carry; // At most 2 * 10^9 - 1
+        carry = sum >= LIMB_BASE ? 1 : 0;
+        a[index] = sum - carry * LIMB_BASE;
+    }
+    if (carry) a.push_back(carry);
 }
 
-bool IntegerString::operator == (const IntegerString& other) const {
-    if(&other == this) return true;
-    if (this->negative != other.negative) return false;
-    // Assumes that aString and bString are have only digits and no leading zeros
-    auto isnumberStringEqual =
-        [](const string_view aString, const string_view bString) -> bool {
-        if (aString.empty() && bString.empty()) return false;
-        if (aString.length() != bString.length()) return false;
-        // Equal Lengths
-        return equal(
-            aString.begin(),
-            aString.end(),
-            bString.begin(),
-            bString.end(),
-            [](char a, char b) {
-            return charToDigit(a) == charToDigit(b);
+void IntegerString::subtractMagnitude(vector<uint32_t>& a, const vector<uint32_t>& b) {
+    uint32_t borrow = 0;
+    for (size_t index = 0; index < a.size(); ++index) {
+        if (index >= b.size() && 0 == borrow) return;
+        uint32_t subtrahend = (index < b.size() ? b[index] : 0) + borrow;
+        borrow = a[index] < subtrahend ? 1 : 0;
+        a[index] = a[index] + borrow * LIMB_BASE - subtrahend;
+    }
+}
+
+void IntegerString::normalize() {
+    while (limbs.size() > 1 && 0 == limbs.back()) limbs.pop_back();
+    if (1 == limbs.size() && 0 == limbs[0]) negative = false;
+}
+
+IntegerString& IntegerString::addSigned(const IntegerString& other, bool otherNegative) {
+    if (!valid() || !other.valid()) {
+        clear();
+        return *this;
+    }
+    if (&other == this) return addSigned(IntegerString{ other }, otherNegative);
+
+    if (negative == otherNegative) {
+        addMagnitude(limbs, other.limbs);
+    } else if (compareMagnitudes(limbs, other.limbs) >= 0) {
+        subtractMagnitude(limbs, other.limbs);
+    } else {
+        auto difference = other.limbs;
+        subtractMagnitude(difference, limbs);
+        limbs = move(difference);
+        negative = otherNegative;
+    }
+    normalize();
+    return *this;
+}
+
+IntegerString& IntegerString::operator *= (const IntegerString& other) {
+    if (!valid() || !other.valid()) {
+        clear();
+        return *this;
+    }
+
+    // Schoolbook multiplication; a limb product plus two limbs still fits in 64 bits
+    vector<uint32_t> product(limbs.size() + other.limbs.size(), 0);
+    for (size_t index = 0; index < limbs.size(); ++index) {
+        uint64_t carry = 0;
+        for (size_t otherIndex = 0; otherIndex < other.limbs.size(); ++otherIndex) {
+            auto current = product[index + otherIndex] + uint64_t{ limbs[index] } * other.limbs[otherIndex] + carry;
+            product[index + otherIndex] = static_cast<uint32_t>(current % LIMB_BASE);
+            carry = current / LIMB_BASE;
         }
-        );
-    };
+        product[index + other.limbs.size()] = static_cast<uint32_t>(carry);
+    }
+    limbs = move(product);
+    negative = negative != other.negative;
+    normalize();
+    return *this;
+}
+
+bool IntegerString::operator < (const IntegerString& other) const {
+    if (&other == this) return false;
+    // Text which is not an integer sorts before every integer
+    if (!other.valid()) return false;
+    if (!this->valid()) return true;
+    if (this->negative != other.negative) return this->negative;
+    auto comparison = compareMagnitudes(this->limbs, other.limbs);
+    return this->negative ? comparison > 0 : comparison < 0;
+}
 
-    return isnumberStringEqual(this->numberString, other.numberString);
+bool IntegerString::operator == (const IntegerString& other) const {
+    if(&other == this) return true;
+    // Text which is not an integer is not equal to other such text
+    if (this->limbs.empty() && other.limbs.empty()) return false;
+    return this->negative == other.negative && this->limbs == other.limbs;
 }
 
 istream& ioUtils::operator >> (istream& is, IntegerString& integerString) {
@@ -128,8 +213,8 @@ ostream& ioUtils::operator << (ostream& os, const IntegerString& integerString)
     return os;
 }
 
-IntegerString::IntegerString(const string_view number) : 
-numberString{ getAbsoluteValueString(number)},
-negative{isNegative(number)}{
-    if(numberString.empty()) negative = false;
+IntegerString::IntegerString(const string_view number) :
+limbs{},
+negative{false}{
+    reset(number);
 };
\ No newline at end of file
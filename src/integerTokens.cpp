@@ -0,0 +1,165 @@
+#include "integerTokens.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(OS_CPU_X86)
+    #include <immintrin.h>
+#endif
+
+namespace ioUtils {
+    using std::uint64_t;
+    using std::uint32_t;
+}
+
+using namespace ioUtils;
+
+static constexpr size_t BLOCK_SIZE = 64;
+
+// One bit per byte of a block
+struct BlockMasks {
+    uint64_t separators{0};
+    uint64_t digits{0};
+    uint64_t signs{0};
+};
+
+using BlockClassifier = BlockMasks(*)(const char* block);
+
+static BlockMasks classifyScalar(const char* block) {
+    BlockMasks masks{};
+    for (size_t index = 0; index < BLOCK_SIZE; ++index) {
+        auto bit = uint64_t{ 1 } << index;
+        auto c = block[index];
+        if (' ' == c || ',' == c || (c >= '\t' && c <= '\r')) {
+            masks.separators |= bit;
+        }else if (c >= '0' && c <= '9') {
+            masks.digits |= bit;
+        }else if ('+' == c || '-' == c) {
+            masks.signs |= bit;
+        }
+    }
+    return masks;
+}
+
+#if defined(OS_CPU_X86)
+
+// Signed byte comparisons are enough because every character classified is ASCII
+static BlockMasks classifySse2(const char* block) {
+    const auto belowZero = _mm_set1_epi8('0' - 1);
+    const auto aboveNine = _mm_set1_epi8('9' + 1);
+    const auto belowTab = _mm_set1_epi8('\t' - 1);
+    const auto aboveReturn = _mm_set1_epi8('\r' + 1);
+    const auto space = _mm_set1_epi8(' ');
+    const auto comma = _mm_set1_epi8(',');
+    const auto plus = _mm_set1_epi8('+');
+    const auto minus = _mm_set1_epi8('-');
+
+    BlockMasks masks{};
+    for (size_t offset = 0; offset < BLOCK_SIZE; offset += 16) {
+        auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + offset));
+        auto digits = _mm_and_si128(_mm_cmpgt_epi8(chars, belowZero), _mm_cmplt_epi8(chars, aboveNine));
+        auto separators = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, comma)),
+            _mm_and_si128(_mm_cmpgt_epi8(chars, belowTab), _mm_cmplt_epi8(chars, aboveReturn))
+        );
+        auto signs = _mm_or_si128(_mm_cmpeq_epi8(chars, plus), _mm_cmpeq_epi8(chars, minus));
+        masks.digits |= uint64_t{ static_cast<uint32_t>(_mm_movemask_epi8(digits)) } << offset;
+        masks.separators |= uint64_t{ static_cast<uint32_t>(_mm_movemask_epi8(separators)) } << offset;
+        masks.signs |= uint64_t{ static_cast<uint32_t>(_mm_movemask_epi8(signs)) } << offset;
+    }
+    return masks;
+}
+
+OS_CPU_TARGET_AVX2 static BlockMasks classifyAvx2(const char* block) {
+    const auto belowZero = _mm256_set1_epi8('0' - 1);
+    const auto aboveNine = _mm256_set1_epi8('9' + 1);
+    const auto belowTab = _mm256_set1_epi8('\t' - 1);
+    const auto aboveReturn = _mm256_set1_epi8('\r' + 1);
+    const auto space = _mm256_set1_epi8(' ');
+    const auto comma = _mm256_set1_epi8(',');
+    const auto plus = _mm256_set1_epi8('+');
+    const auto minus = _mm256_set1_epi8('-');
+
+    BlockMasks masks{};
+    for (size_t offset = 0; offset < BLOCK_SIZE; offset += 32) {
+        auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + offset));
+        auto digits = _mm256_and_si256(_mm256_cmpgt_epi8(chars, belowZero), _mm256_cmpgt_epi8(aboveNine, chars));
+        auto separators = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chars, space), _mm256_cmpeq_epi8(chars, comma)),
+            _mm256_and_si256(_mm256_cmpgt_epi8(chars, belowTab), _mm256_cmpgt_epi8(aboveReturn, chars))
+        );
+        auto signs = _mm256_or_si256(_mm256_cmpeq_epi8(chars, plus), _mm256_cmpeq_epi8(chars, minus));
+        masks.digits |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(digits)) } << offset;
+        masks.separators |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(separators)) } << offset;
+        masks.signs |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(signs)) } << offset;
+    }
+    return masks;
+}
+
+#endif
+
+static BlockClassifier classifierFor(ScanPath path) {
+    path = std::min(path, bestScanPath());
+    #if defined(OS_CPU_X86)
+        if (ScanPath::AVX2 == path) return classifyAvx2;
+        if (ScanPath::SSE2 == path) return classifySse2;
+    #endif
+    return classifyScalar;
+}
+
+// Bits [first, last) of a block; last is below 64
+static uint64_t bitRange(unsigned first, unsigned last) {
+    return ((uint64_t{ 1 } << last) - 1) & ~((uint64_t{ 1 } << first) - 1);
+}
+
+void ioUtils::scanIntegerTokens(string_view input, vector<IntegerToken>& tokens, ScanPath path) {
+    tokens.clear();
+    auto classify = classifierFor(path);
+
+    bool inToken = false;
+    IntegerToken token{};
+    auto closeToken = [&input, &tokens, &token, &inToken](size_t end) {
+        token.length = end - token.offset;
+        // A sign alone is not a number
+        if (1 == token.length && ('+' == input[token.offset] || '-' == input[token.offset])) token.valid = false;
+        tokens.push_back(token);
+        inToken = false;
+    };
+
+    char lastBlock[BLOCK_SIZE];
+    for (size_t blockStart = 0; blockStart < input.size(); blockStart += BLOCK_SIZE) {
+        const char* block = input.data() + blockStart;
+        auto blockLength = std::min(BLOCK_SIZE, input.size() - blockStart);
+        if (blockLength < BLOCK_SIZE) {
+            // Pad with separators so the last token ends inside the block
+            std::memcpy(lastBlock, block, blockLength);
+            std::memset(lastBlock + blockLength, ' ', BLOCK_SIZE - blockLength);
+            block = lastBlock;
+        }
+
+        auto masks = classify(block);
+        auto inside = ~masks.separators;
+        auto insideBefore = (inside << 1) | (inToken ? 1 : 0);
+        auto starts = inside & ~insideBefore;
+        auto ends = masks.separators & insideBefore;
+        // Anything but a digit, or a sign at the start of its token, makes a token invalid
+        auto invalid = inside & ~masks.digits & ~(masks.signs & starts);
+
+        unsigned tokenStartInBlock = 0;
+        for (auto events = starts | ends; 0 != events; events &= events - 1) {
+            auto position = static_cast<unsigned>(std::countr_zero(events));
+            if (0 != (starts & (uint64_t{ 1 } << position))) {
+                token = { blockStart + position, 0, true };
+                tokenStartInBlock = position;
+                inToken = true;
+            }else {
+                token.valid = token.valid && 0 == (invalid & bitRange(tokenStartInBlock, position));
+                closeToken(blockStart + position);
+            }
+        }
+        if (inToken) token.valid = token.valid && 0 == (invalid & ~((uint64_t{ 1 } << tokenStartInBlock) - 1));
+    }
+    if (inToken) closeToken(input.size());
+}
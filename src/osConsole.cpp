@@ -1,27 +1,100 @@
 #include "osName.h"
 #include "osConsole.h"
 #include <cstdlib>
-#include <stdexcept>
+#include <cstdio>
+#include <charconv>
+#include <limits>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+    #include <io.h>
+    #define isatty _isatty
+    #define fileno _fileno
+#else
+    #include <unistd.h>
+#endif
 
 namespace osUtils {
-    using std::runtime_error;
-    using std::abort;
+    using std::cout;
+    using std::cerr;
+    using std::clog;
+}
+
+using namespace osUtils;
+
+#if defined(_WIN32)
+// Windows consoles interpret ANSI escape sequences only once virtual terminal processing is enabled
+static bool enableVirtualTerminal(DWORD standardHandle) {
+    HANDLE handle = GetStdHandle(standardHandle);
+    DWORD mode = 0;
+    if (INVALID_HANDLE_VALUE == handle || !GetConsoleMode(handle, &mode)) return false;
+    if (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) return true;
+    return SetConsoleMode(handle, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
 }
+#endif
 
-void osUtils::clearScreen() {
+static bool isTerminalFile(FILE* file) {
+    if (0 == isatty(fileno(file))) return false;
+#if defined(_WIN32)
+    enableVirtualTerminal(file == stdout ? STD_OUTPUT_HANDLE : STD_ERROR_HANDLE);
+#endif
+    return true;
+}
 
-    try {
-        int exitCode;
+bool osUtils::clearScreen(ostream& os, ClearMethod method) {
 
-        if (OS::is(OS::NAME::WINDOWS)) {
-            exitCode = system("cls");
-        }
-        else {
-            exitCode = system("clear");
-        }
-        if (0 != exitCode) throw std::runtime_error("Error while attemppting to clear screen via a OS command");
-    }catch (...) {
-        std::abort();
+    if (ClearMethod::EscapeSequence == method) {
+        os << "\x1b[H\x1b[2J";
+        return static_cast<bool>(os);
     }
+
+    // Anything buffered in os has to reach the console before the command clears it
+    os.flush();
+    int exitCode;
+
+    if (OS::is(OS::NAME::WINDOWS)) {
+        exitCode = system("cls");
+    }
+    else {
+        exitCode = system("clear");
+    }
+    return 0 == exitCode;
+}
+
+bool osUtils::isTerminal(const ostream& os) {
+    auto buffer = os.rdbuf();
+    if (nullptr == buffer) return false;
+    if (buffer == cout.rdbuf()) return isTerminalFile(stdout);
+    if (buffer == cerr.rdbuf() || buffer == clog.rdbuf()) return isTerminalFile(stderr);
+    return false;
 }
 
+ostream& osUtils::moveCursor(ostream& os, size_t row, size_t column) {
+    return os << "\x1b[" << row << ';' << column << 'H';
+}
+
+string& osUtils::moveCursor(string& frame, size_t row, size_t column) {
+    char digits[std::numeric_limits<size_t>::digits10 + 1];
+    frame += "\x1b[";
+    frame.append(digits, std::to_chars(digits, digits + sizeof(digits), row).ptr) += ';';
+    frame.append(digits, std::to_chars(digits, digits + sizeof(digits), column).ptr) += 'H';
+    return frame;
+}
+
+ostream& osUtils::clearToEndOfLine(ostream& os) {
+    return os << "\x1b[K";
+}
+
+string& osUtils::clearToEndOfLine(string& frame) {
+    return frame += "\x1b[K";
+}
+
+ostream& osUtils::clearToEndOfScreen(ostream& os) {
+    return os << "\x1b[J";
+}
+
+string& osUtils::clearToEndOfScreen(string& frame) {
+    return frame += "\x1b[J";
+}
@@ -0,0 +1,53 @@
+/*********************************************************************
+ * @file  osCpu.cpp
+ *
+ * @brief Run time check of the vector instruction sets
+ *********************************************************************/
+
+#include "osCpu.h"
+
+#if defined(OS_CPU_X86) && defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+using namespace osUtils;
+
+#if defined(OS_CPU_X86)
+
+static bool supportsAvx2() {
+    #if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+}
+
+static bool supportsSse2() {
+    #if defined(__x86_64__) || defined(_M_X64)
+        return true;
+    #elif defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 1);
+        return info[3] & (1 << 26);
+    #else
+        return __builtin_cpu_supports("sse2");
+    #endif
+}
+
+#endif
+
+ScanPath osUtils::bestScanPath() {
+    #if defined(OS_CPU_X86)
+        static const ScanPath best = supportsAvx2() ? ScanPath::AVX2 : supportsSse2() ? ScanPath::SSE2 : ScanPath::Scalar;
+        return best;
+    #else
+        return ScanPath::Scalar;
+    #endif
+}
@@ -0,0 +1,151 @@
+#include "osEventLoop.h"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <iterator>
+#include <system_error>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace osUtils {
+    using std::chrono::milliseconds;
+}
+
+using namespace osUtils;
+
+Task& Task::operator=(Task&& other) noexcept {
+    if (this == &other) return *this;
+    if (handle) handle.destroy();
+    handle = other.handle;
+    other.handle = {};
+    return *this;
+}
+
+EventLoop::EventLoop() : epollFd{ epoll_create1(EPOLL_CLOEXEC) } {
+    if (epollFd < 0) throw std::system_error(errno, std::generic_category(), "epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+    close(epollFd);
+}
+
+void EventLoop::FdAwaiter::await_suspend(coroutine_handle<> handle) {
+    loop.addWaiter(fd, direction, handle);
+    waiting = true;
+}
+
+void EventLoop::TimerAwaiter::await_suspend(coroutine_handle<> handle) {
+    timer = loop.timers.emplace(deadline, handle);
+    waiting = true;
+}
+
+// Events epoll has to report for the coroutines waiting on a file descriptor
+static uint32_t watchedEvents(bool reading, bool writing) {
+    return (reading ? EPOLLIN | EPOLLRDHUP : 0u) | (writing ? EPOLLOUT : 0u);
+}
+
+void EventLoop::addWaiter(int fd, Direction direction, coroutine_handle<> handle) {
+    auto [waiters, added] = fdWaiters.try_emplace(fd);
+    auto& waiter = Direction::Read == direction ? waiters->second.reader : waiters->second.writer;
+    if (waiter) throw "Only one coroutine can wait for a file descriptor to be readable, and one for it to be writable";
+
+    epoll_event event{};
+    event.events = watchedEvents(
+        Direction::Read == direction || waiters->second.reader,
+        Direction::Write == direction || waiters->second.writer
+    );
+    event.data.fd = fd;
+    if (!waiters->second.alwaysReady && 0 != epoll_ctl(epollFd, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event)) {
+        auto error = errno;
+        if (!added || EPERM != error) {
+            if (added) fdWaiters.erase(waiters);
+            throw std::system_error(error, std::generic_category(), "epoll_ctl");
+        }
+        // A regular file can be read or written without waiting
+        waiters->second.alwaysReady = true;
+        alwaysReadyFds.push_back(fd);
+    }
+    waiter = handle;
+}
+
+void EventLoop::removeWaiter(int fd, Direction direction) {
+    auto waiters = fdWaiters.find(fd);
+    if (waiters == fdWaiters.end()) return;
+    (Direction::Read == direction ? waiters->second.reader : waiters->second.writer) = {};
+    if (waiters->second.alwaysReady) {
+        if (waiters->second.reader || waiters->second.writer) return;
+        std::erase(alwaysReadyFds, fd);
+        fdWaiters.erase(waiters);
+        return;
+    }
+    if (!waiters->second.reader && !waiters->second.writer) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        fdWaiters.erase(waiters);
+        return;
+    }
+    epoll_event event{};
+    event.events = watchedEvents(static_cast<bool>(waiters->second.reader), static_cast<bool>(waiters->second.writer));
+    event.data.fd = fd;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &event);
+}
+
+// Resumes the coroutine waiting on fd in direction, if there still is one
+void EventLoop::resumeWaiter(int fd, Direction direction) {
+    auto waiters = fdWaiters.find(fd);
+    if (waiters == fdWaiters.end()) return;
+    auto handle = Direction::Read == direction ? waiters->second.reader : waiters->second.writer;
+    if (!handle) return;
+    removeWaiter(fd, direction);
+    handle.resume();
+}
+
+bool EventLoop::runOnce(milliseconds timeout) {
+    if (!hasWaiters()) return false;
+
+    // Sleep no longer than until the earliest timer
+    int timeoutMilliseconds = timeout.count() < 0 ? -1 : static_cast<int>(timeout.count());
+    if (!alwaysReadyFds.empty()) timeoutMilliseconds = 0; // Only collect what else is ready
+    if (!timers.empty()) {
+        // Round up so the timer has expired when epoll_wait returns
+        auto untilTimer = std::chrono::ceil<milliseconds>(timers.begin()->first - steadyClock::now());
+        auto timerMilliseconds = static_cast<int>(std::max<milliseconds::rep>(0, untilTimer.count()));
+        if (timeoutMilliseconds < 0 || timerMilliseconds < timeoutMilliseconds) timeoutMilliseconds = timerMilliseconds;
+    }
+
+    epoll_event events[16];
+    int eventCount = epoll_wait(epollFd, events, static_cast<int>(std::size(events)), timeoutMilliseconds);
+    if (eventCount < 0 && EINTR != errno) throw std::system_error(errno, std::generic_category(), "epoll_wait");
+
+    // Each wait is unregistered right before its coroutine resumes, so a resumed coroutine
+    // can wait again on the same fd or destroy other tasks whose waits then cancel themselves
+    // Both waiters are looked up again, as resuming the reader may end the writer's wait
+    for (int index = 0; index < eventCount; ++index) {
+        auto fd = events[index].data.fd;
+        auto ready = events[index].events;
+        if (ready & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) resumeWaiter(fd, Direction::Read);
+        if (ready & (EPOLLOUT | EPOLLHUP | EPOLLERR)) resumeWaiter(fd, Direction::Write);
+    }
+    // Copied, as the resumed coroutines may wait on or stop waiting on regular files
+    auto readyFds = alwaysReadyFds;
+    for (auto fd : readyFds) {
+        resumeWaiter(fd, Direction::Read);
+        resumeWaiter(fd, Direction::Write);
+    }
+    auto now = steadyClock::now();
+    while (!timers.empty() && timers.begin()->first <= now) {
+        auto handle = timers.begin()->second;
+        timers.erase(timers.begin());
+        handle.resume();
+    }
+    return hasWaiters();
+}
+
+void EventLoop::run() {
+    stopped = false;
+    while (!stopped && runOnce()) {}
+}
+
+#endif
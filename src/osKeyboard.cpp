@@ -0,0 +1,221 @@
+#include "osKeyboard.h"
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+
+#if defined(_WIN32)
+    #include <conio.h>
+    #include <io.h>
+    #define isatty _isatty
+#else
+    #include <cerrno>
+    #include <csignal>
+    #include <poll.h>
+    #include <termios.h>
+    #include <unistd.h>
+#endif
+
+using namespace osUtils;
+
+// Time to wait for the rest of an escape sequence before a lone ESC counts as the Escape key
+static constexpr int ESCAPE_TIMEOUT_MILLISECONDS = 25;
+
+static constexpr char ESCAPE = '\x1b';
+
+static bool isFinalByte(char c) {
+    return c >= 0x40 && c <= 0x7e;
+}
+
+size_t osUtils::decodeKey(string_view bytes, KeyPress& keyPress) {
+    keyPress = {};
+    if (bytes.empty()) return 0;
+
+    auto first = static_cast<unsigned char>(bytes[0]);
+    if (ESCAPE != bytes[0]) {
+        if ('\r' == first || '\n' == first) {
+            keyPress.key = Key::Enter;
+        }else if (0x7f == first || '\b' == first) {
+            keyPress.key = Key::Backspace;
+        }else if (0x04 == first) { // Ctrl-D
+            keyPress.key = Key::EndOfInput;
+        }else if (first >= 0x20) {
+            keyPress.key = Key::Character;
+            keyPress.character = bytes[0];
+        }
+        return 1;
+    }
+
+    if (bytes.size() < 2) return 0;
+    if (ESCAPE == bytes[1]) {
+        keyPress.key = Key::Escape; // The second ESC may start a key of its own
+        return 1;
+    }
+    if ('[' != bytes[1] && 'O' != bytes[1]) {
+        return 2; // Alt with a key, which is ignored rather than read as Escape and then the key alone
+    }
+
+    // ESC [ parameters final or ESC O final
+    size_t end = 2;
+    while (end < bytes.size() && !isFinalByte(bytes[end])) ++end;
+    if (end == bytes.size()) return 0;
+
+    auto parameters = bytes.substr(2, end - 2);
+    switch (bytes[end]) {
+        case 'A': keyPress.key = Key::Up; break;
+        case 'B': keyPress.key = Key::Down; break;
+        case 'C': keyPress.key = Key::Right; break;
+        case 'D': keyPress.key = Key::Left; break;
+        case 'H': keyPress.key = Key::Home; break;
+        case 'F': keyPress.key = Key::End; break;
+        case '~':
+            if ("1" == parameters || "7" == parameters) keyPress.key = Key::Home;
+            if ("4" == parameters || "8" == parameters) keyPress.key = Key::End;
+            break;
+        default: break;
+    }
+    return end + 1;
+}
+
+#if defined(_WIN32)
+
+RawTerminal::RawTerminal(int fd) : fd{ fd } {
+    // _getch already reads single keys without echo
+    active = 0 != isatty(fd);
+}
+
+RawTerminal::~RawTerminal() {}
+
+bool RawTerminal::readMore(int) {
+    return false;
+}
+
+KeyPress RawTerminal::readKey() {
+    int c = _getch();
+    if (0 == c || 0xe0 == c) { // Prefix of an extended key
+        switch (_getch()) {
+            case 72: return { Key::Up };
+            case 80: return { Key::Down };
+            case 75: return { Key::Left };
+            case 77: return { Key::Right };
+            case 71: return { Key::Home };
+            case 79: return { Key::End };
+            default: return { Key::None };
+        }
+    }
+    if (0x1a == c) return { Key::EndOfInput }; // Ctrl-Z
+    if (ESCAPE == c) return { Key::Escape };
+
+    KeyPress keyPress{};
+    char character = static_cast<char>(c);
+    decodeKey({ &character, 1 }, keyPress);
+    return keyPress;
+}
+
+#else
+
+static termios savedState{};
+static int savedFd = -1;
+static volatile std::sig_atomic_t stateSaved = 0;
+
+static constexpr int RESTORING_SIGNALS[] = { SIGINT, SIGTERM, SIGHUP, SIGQUIT };
+static struct sigaction previousActions[std::size(RESTORING_SIGNALS)]{};
+
+static void restoreTerminal() {
+    if (0 == stateSaved) return;
+    tcsetattr(savedFd, TCSAFLUSH, &savedState);
+    stateSaved = 0;
+}
+
+// Only calls async signal safe functions
+static void restoreTerminalAndRaise(int signal) {
+    restoreTerminal();
+    for (size_t index = 0; index < std::size(RESTORING_SIGNALS); ++index) {
+        if (RESTORING_SIGNALS[index] == signal) sigaction(signal, &previousActions[index], nullptr);
+    }
+    raise(signal);
+}
+
+static void restoreSignalHandlers() {
+    for (size_t index = 0; index < std::size(RESTORING_SIGNALS); ++index) {
+        sigaction(RESTORING_SIGNALS[index], &previousActions[index], nullptr);
+    }
+}
+
+RawTerminal::RawTerminal(int fd) : fd{ fd } {
+    if (0 == isatty(fd) || 0 != stateSaved) return;
+
+    termios state{};
+    if (0 != tcgetattr(fd, &state)) return;
+    savedState = state;
+    savedFd = fd;
+    stateSaved = 1;
+
+    static bool exitHandlerRegistered = false;
+    if (!exitHandlerRegistered) exitHandlerRegistered = 0 == std::atexit(restoreTerminal);
+
+    struct sigaction action{};
+    action.sa_handler = restoreTerminalAndRaise;
+    sigemptyset(&action.sa_mask);
+    for (size_t index = 0; index < std::size(RESTORING_SIGNALS); ++index) {
+        sigaction(RESTORING_SIGNALS[index], &action, &previousActions[index]);
+    }
+
+    // ISIG stays set so that Ctrl-C still stops the program
+    state.c_lflag &= ~(ICANON | ECHO);
+    state.c_cc[VMIN] = 1;
+    state.c_cc[VTIME] = 0;
+    active = 0 == tcsetattr(fd, TCSAFLUSH, &state);
+    if (!active) {
+        stateSaved = 0;
+        restoreSignalHandlers();
+    }
+}
+
+RawTerminal::~RawTerminal() {
+    if (!active) return;
+    restoreTerminal();
+    restoreSignalHandlers();
+}
+
+bool RawTerminal::readMore(int timeoutMilliseconds) {
+    if (timeoutMilliseconds >= 0) {
+        pollfd input{ fd, POLLIN, 0 };
+        if (poll(&input, 1, timeoutMilliseconds) <= 0) return false;
+    }
+    while (true) {
+        auto bytesRead = read(fd, pending + pendingCount, sizeof(pending) - pendingCount);
+        if (bytesRead > 0) {
+            pendingCount += static_cast<size_t>(bytesRead);
+            return true;
+        }
+        if (bytesRead < 0 && EINTR == errno) continue;
+        return false;
+    }
+}
+
+KeyPress RawTerminal::readKey() {
+    if (!active) return { Key::EndOfInput };
+    while (true) {
+        KeyPress keyPress{};
+        auto used = decodeKey({ pending, pendingCount }, keyPress);
+        if (0 == used && pendingCount == sizeof(pending)) {
+            used = pendingCount; // Sequence too long to be a key
+            keyPress = {};
+        }
+        if (used > 0) {
+            std::memmove(pending, pending + used, pendingCount - used);
+            pendingCount -= used;
+            return keyPress;
+        }
+
+        if (readMore(0 == pendingCount ? -1 : ESCAPE_TIMEOUT_MILLISECONDS)) continue;
+        if (0 == pendingCount) return { Key::EndOfInput };
+
+        // Nothing completed the sequence, so its escape was a key of its own
+        std::memmove(pending, pending + 1, pendingCount - 1);
+        --pendingCount;
+        return { Key::Escape };
+    }
+}
+
+#endif
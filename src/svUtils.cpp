@@ -1,12 +1,30 @@
 #pragma once
 #include "svUtils.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
 #include <string>
 #include <iostream>
 #include <tuple>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SV_UTILS_SSE2
+    #include <emmintrin.h>
+#endif
+#if defined(OS_CPU_X86)
+    #include <immintrin.h>
+#endif
+
 namespace svUtils {
     using std::string;
     using std::make_tuple;
+    using std::array;
+    using std::uint64_t;
+    using std::uint32_t;
+    using std::span;
 }
 
 using namespace svUtils;
@@ -40,87 +58,461 @@ SVSplit svUtils::splitByDelimiter(
 }
 
 
-void svUtils::wrapToLength(
-    ostream& os,
+static constexpr size_t SCAN_BLOCK_SIZE = 64;
+
+// One bit per byte of a block
+struct ScanMasks {
+    uint64_t delimiters{0};
+    uint64_t newLines{0};
+};
+
+using BlockScanner = ScanMasks(*)(const char* block, char delimiter);
+
+static ScanMasks scanBlockScalar(const char* block, char delimiter) {
+    ScanMasks masks{};
+    for (size_t index = 0; index < SCAN_BLOCK_SIZE; ++index) {
+        auto bit = uint64_t{ 1 } << index;
+        if (delimiter == block[index]) masks.delimiters |= bit;
+        if ('\n' == block[index]) masks.newLines |= bit;
+    }
+    return masks;
+}
+
+#if defined(OS_CPU_X86)
+
+static ScanMasks scanBlockSse2(const char* block, char delimiter) {
+    const auto delimiters = _mm_set1_epi8(delimiter);
+    const auto newLines = _mm_set1_epi8('\n');
+    ScanMasks masks{};
+    for (size_t offset = 0; offset < SCAN_BLOCK_SIZE; offset += 16) {
+        auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + offset));
+        masks.delimiters |= uint64_t{ static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, delimiters))) } << offset;
+        masks.newLines |= uint64_t{ static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLines))) } << offset;
+    }
+    return masks;
+}
+
+OS_CPU_TARGET_AVX2 static ScanMasks scanBlockAvx2(const char* block, char delimiter) {
+    const auto delimiters = _mm256_set1_epi8(delimiter);
+    const auto newLines = _mm256_set1_epi8('\n');
+    ScanMasks masks{};
+    for (size_t offset = 0; offset < SCAN_BLOCK_SIZE; offset += 32) {
+        auto chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + offset));
+        masks.delimiters |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, delimiters))) } << offset;
+        masks.newLines |= uint64_t{ static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newLines))) } << offset;
+    }
+    return masks;
+}
+
+#endif
+
+static BlockScanner scannerFor(ScanPath path) {
+    path = std::min(path, bestScanPath());
+    #if defined(OS_CPU_X86)
+        if (ScanPath::AVX2 == path) return scanBlockAvx2;
+        if (ScanPath::SSE2 == path) return scanBlockSse2;
+    #endif
+    return scanBlockScalar;
+}
+
+void svUtils::scanDelimiters(
+    string_view text,
+    string_view delimiter,
+    DelimiterPositions& positions,
+    ScanPath path
+) {
+    positions.delimiters.clear();
+    positions.newLines.clear();
+    auto scanBlock = scannerFor(path);
+
+    char lastBlock[SCAN_BLOCK_SIZE];
+    for (size_t blockStart = 0; blockStart < text.size(); blockStart += SCAN_BLOCK_SIZE) {
+        const char* block = text.data() + blockStart;
+        auto blockLength = std::min(SCAN_BLOCK_SIZE, text.size() - blockStart);
+        auto inText = ~uint64_t{ 0 };
+        if (blockLength < SCAN_BLOCK_SIZE) {
+            std::memcpy(lastBlock, block, blockLength);
+            std::memset(lastBlock + blockLength, 0, SCAN_BLOCK_SIZE - blockLength);
+            block = lastBlock;
+            inText = (uint64_t{ 1 } << blockLength) - 1;
+        }
+
+        auto masks = scanBlock(block, delimiter.empty() ? '\n' : delimiter[0]);
+        if (delimiter.empty()) masks.delimiters = ~uint64_t{ 0 };
+        for (auto newLines = masks.newLines & inText; 0 != newLines; newLines &= newLines - 1) {
+            positions.newLines.push_back(blockStart + static_cast<size_t>(std::countr_zero(newLines)));
+        }
+        for (auto candidates = masks.delimiters & inText; 0 != candidates; candidates &= candidates - 1) {
+            auto position = blockStart + static_cast<size_t>(std::countr_zero(candidates));
+            if (delimiter.length() <= 1 || text.substr(position).starts_with(delimiter)) positions.delimiters.push_back(position);
+        }
+    }
+}
+
+bool svUtils::isAscii(string_view text) {
+    const char* data = text.data();
+    size_t size = text.size();
+    size_t index = 0;
+    #if defined(SV_UTILS_SSE2)
+        for (; index + 64 <= size; index += 64) {
+            auto bytes = _mm_or_si128(
+                _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 16))),
+                _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index + 48)))
+            );
+            if (0 != _mm_movemask_epi8(bytes)) return false;
+        }
+    #endif
+    for (; index + 8 <= size; index += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + index, sizeof(word));
+        if (0 != (word & 0x8080808080808080)) return false;
+    }
+    for (; index < size; ++index) {
+        if (static_cast<unsigned char>(data[index]) >= 0x80) return false;
+    }
+    return true;
+}
+
+struct WidthRange {
+    char32_t first;
+    char32_t last;
+    unsigned char width;
+};
+
+// Code points which do not take one column, sorted. Zero width: combining marks, Hangul medial
+// vowels, format characters, variation selectors and tags. Two columns: East Asian wide and fullwidth
+static constexpr WidthRange WIDTH_RANGES[] = {
+    {0x0080, 0x009F, 0}, {0x0300, 0x036F, 0}, {0x0483, 0x0489, 0}, {0x0591, 0x05BD, 0},
+    {0x05BF, 0x05BF, 0}, {0x05C1, 0x05C2, 0}, {0x05C4, 0x05C5, 0}, {0x05C7, 0x05C7, 0},
+    {0x0610, 0x061A, 0}, {0x064B, 0x065F, 0}, {0x0670, 0x0670, 0}, {0x06D6, 0x06DC, 0},
+    {0x06DF, 0x06E4, 0}, {0x06E7, 0x06E8, 0}, {0x06EA, 0x06ED, 0}, {0x0711, 0x0711, 0},
+    {0x0730, 0x074A, 0}, {0x0900, 0x0902, 0}, {0x093A, 0x093A, 0}, {0x093C, 0x093C, 0},
+    {0x0941, 0x0948, 0}, {0x094D, 0x094D, 0}, {0x0951, 0x0957, 0}, {0x0962, 0x0963, 0},
+    {0x0E31, 0x0E31, 0}, {0x0E34, 0x0E3A, 0}, {0x0E47, 0x0E4E, 0}, {0x1100, 0x115F, 2},
+    {0x1160, 0x11FF, 0}, {0x1AB0, 0x1AFF, 0}, {0x1DC0, 0x1DFF, 0}, {0x200B, 0x200F, 0},
+    {0x202A, 0x202E, 0}, {0x2060, 0x2064, 0}, {0x20D0, 0x20FF, 0}, {0x231A, 0x231B, 2},
+    {0x2329, 0x232A, 2}, {0x23E9, 0x23EC, 2}, {0x23F0, 0x23F0, 2}, {0x23F3, 0x23F3, 2},
+    {0x25FD, 0x25FE, 2}, {0x2614, 0x2615, 2}, {0x2648, 0x2653, 2}, {0x267F, 0x267F, 2},
+    {0x2693, 0x2693, 2}, {0x26A1, 0x26A1, 2}, {0x26AA, 0x26AB, 2}, {0x26BD, 0x26BE, 2},
+    {0x26C4, 0x26C5, 2}, {0x26CE, 0x26CE, 2}, {0x26D4, 0x26D4, 2}, {0x26EA, 0x26EA, 2},
+    {0x26F2, 0x26F3, 2}, {0x26F5, 0x26F5, 2}, {0x26FA, 0x26FA, 2}, {0x26FD, 0x26FD, 2},
+    {0x2705, 0x2705, 2}, {0x270A, 0x270B, 2}, {0x2728, 0x2728, 2}, {0x274C, 0x274C, 2},
+    {0x274E, 0x274E, 2}, {0x2753, 0x2755, 2}, {0x2757, 0x2757, 2}, {0x2795, 0x2797, 2},
+    {0x27B0, 0x27B0, 2}, {0x27BF, 0x27BF, 2}, {0x2B1B, 0x2B1C, 2}, {0x2B50, 0x2B50, 2},
+    {0x2B55, 0x2B55, 2}, {0x2E80, 0x303E, 2}, {0x3041, 0x33FF, 2}, {0x3400, 0x4DBF, 2},
+    {0x4E00, 0x9FFF, 2}, {0xA000, 0xA4CF, 2}, {0xA960, 0xA97F, 2}, {0xAC00, 0xD7A3, 2},
+    {0xF900, 0xFAFF, 2}, {0xFE00, 0xFE0F, 0}, {0xFE10, 0xFE19, 2}, {0xFE20, 0xFE2F, 0},
+    {0xFE30, 0xFE6F, 2}, {0xFEFF, 0xFEFF, 0}, {0xFF00, 0xFF60, 2}, {0xFFE0, 0xFFE6, 2},
+    {0x16FE0, 0x16FE4, 2}, {0x17000, 0x187F7, 2}, {0x18800, 0x18CD5, 2}, {0x1B000, 0x1B2FB, 2},
+    {0x1D167, 0x1D169, 0}, {0x1F004, 0x1F004, 2}, {0x1F0CF, 0x1F0CF, 2}, {0x1F18E, 0x1F18E, 2},
+    {0x1F191, 0x1F19A, 2}, {0x1F200, 0x1F202, 2}, {0x1F210, 0x1F23B, 2}, {0x1F240, 0x1F248, 2},
+    {0x1F250, 0x1F251, 2}, {0x1F260, 0x1F265, 2}, {0x1F300, 0x1F320, 2}, {0x1F32D, 0x1F335, 2},
+    {0x1F337, 0x1F37C, 2}, {0x1F37E, 0x1F393, 2}, {0x1F3A0, 0x1F3CA, 2}, {0x1F3CF, 0x1F3D3, 2},
+    {0x1F3E0, 0x1F3F0, 2}, {0x1F3F4, 0x1F3F4, 2}, {0x1F3F8, 0x1F43E, 2}, {0x1F440, 0x1F440, 2},
+    {0x1F442, 0x1F4FC, 2}, {0x1F4FF, 0x1F53D, 2}, {0x1F54B, 0x1F54E, 2}, {0x1F550, 0x1F567, 2},
+    {0x1F57A, 0x1F57A, 2}, {0x1F595, 0x1F596, 2}, {0x1F5A4, 0x1F5A4, 2}, {0x1F5FB, 0x1F64F, 2},
+    {0x1F680, 0x1F6C5, 2}, {0x1F6CC, 0x1F6CC, 2}, {0x1F6D0, 0x1F6D2, 2}, {0x1F6D5, 0x1F6D7, 2},
+    {0x1F6EB, 0x1F6EC, 2}, {0x1F6F4, 0x1F6FC, 2}, {0x1F7E0, 0x1F7EB, 2}, {0x1F90C, 0x1F93A, 2},
+    {0x1F93C, 0x1F945, 2}, {0x1F947, 0x1F9FF, 2}, {0x1FA70, 0x1FAFF, 2}, {0x20000, 0x2FFFD, 2},
+    {0x30000, 0x3FFFD, 2}, {0xE0001, 0xE0001, 0}, {0xE0020, 0xE007F, 0}, {0xE0100, 0xE01EF, 0}
+};
+
+static constexpr bool areSortedAndDisjoint(const auto& ranges) {
+    for (size_t index = 0; index < std::size(ranges); ++index) {
+        if (ranges[index].first > ranges[index].last) return false;
+        if (index > 0 && ranges[index - 1].last >= ranges[index].first) return false;
+    }
+    return true;
+}
+static_assert(areSortedAndDisjoint(WIDTH_RANGES));
+
+static constexpr size_t WIDTH_PAGE_BITS = 8;
+static constexpr char32_t WIDTH_PAGED_LIMIT = 0x40000;
+static constexpr unsigned char MIXED_WIDTH_PAGE = 0xFF;
+
+// Width of every page of 256 code points below WIDTH_PAGED_LIMIT which has the same width throughout,
+// generated from WIDTH_RANGES at compile time. Only the code points of mixed pages are searched for
+static constexpr auto WIDTH_PAGES = []() {
+    array<unsigned char, (WIDTH_PAGED_LIMIT >> WIDTH_PAGE_BITS)> pages{};
+    pages.fill(1);
+    for (const auto& range : WIDTH_RANGES) {
+        for (auto page = range.first >> WIDTH_PAGE_BITS; page <= range.last >> WIDTH_PAGE_BITS && page < pages.size(); ++page) {
+            char32_t pageFirst = page << WIDTH_PAGE_BITS;
+            char32_t pageLast = pageFirst + (char32_t{ 1 } << WIDTH_PAGE_BITS) - 1;
+            bool coversPage = range.first <= pageFirst && range.last >= pageLast;
+            pages[page] = coversPage ? range.width : MIXED_WIDTH_PAGE;
+        }
+    }
+    return pages;
+}();
+
+size_t svUtils::codePointWidth(char32_t codePoint) {
+    if (codePoint < 0x80) return 1;
+    if (codePoint < WIDTH_PAGED_LIMIT) {
+        auto pageWidth = WIDTH_PAGES[codePoint >> WIDTH_PAGE_BITS];
+        if (MIXED_WIDTH_PAGE != pageWidth) return pageWidth;
+    }
+    auto range = std::upper_bound(std::begin(WIDTH_RANGES), std::end(WIDTH_RANGES), codePoint,
+        [](char32_t codePoint, const WidthRange& range) { return codePoint < range.first; });
+    if (range == std::begin(WIDTH_RANGES) || (--range)->last < codePoint) return 1;
+    return range->width;
+}
+
+static constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+// Decodes the code point text starts with; a byte which does not start a valid sequence is one replacement character
+static char32_t decodeCodePoint(string_view text, size_t& length) {
+    auto lead = static_cast<unsigned char>(text[0]);
+    length = 1;
+    if (lead < 0x80) return lead;
+
+    size_t sequenceLength = lead < 0xC2 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF5 ? 4 : 0;
+    if (0 == sequenceLength || text.length() < sequenceLength) return REPLACEMENT_CHARACTER;
+    char32_t codePoint = lead & (0x7F >> sequenceLength);
+    for (size_t index = 1; index < sequenceLength; ++index) {
+        auto continuation = static_cast<unsigned char>(text[index]);
+        if (0x80 != (continuation & 0xC0)) return REPLACEMENT_CHARACTER;
+        codePoint = (codePoint << 6) | (continuation & 0x3F);
+    }
+    // Overlong encodings, surrogates and code points past U+10FFFF
+    if ((3 == sequenceLength && codePoint < 0x800) ||
+        (4 == sequenceLength && (codePoint < 0x10000 || codePoint > 0x10FFFF)) ||
+        (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        return REPLACEMENT_CHARACTER;
+    }
+    length = sequenceLength;
+    return codePoint;
+}
+
+// Leading bytes of a text which fit into a number of columns
+struct TextFit {
+    size_t length{0};
+    size_t columns{0};
+};
+
+// Measures text as one column per byte
+struct AsciiText {
+    static TextFit fit(string_view text, size_t columns) {
+        auto length = std::min(text.length(), columns);
+        return { length, length };
+    }
+    static size_t width(string_view text) { return text.length(); }
+    static size_t firstCharacterLength(string_view) { return 1; }
+};
+
+// Measures text in display columns of its code points
+struct Utf8Text {
+    // Zero width code points after the last one which fits are included
+    static TextFit fit(string_view text, size_t columns) {
+        TextFit fit{};
+        while (fit.length < text.length()) {
+            size_t length = 1, width = 1;
+            if (static_cast<unsigned char>(text[fit.length]) >= 0x80) {
+                width = codePointWidth(decodeCodePoint(text.substr(fit.length), length));
+            }
+            if (fit.columns + width > columns) break;
+            fit.columns += width;
+            fit.length += length;
+        }
+        return fit;
+    }
+    static size_t width(string_view text) { return fit(text, text.length() * 2).columns; }
+    static size_t firstCharacterLength(string_view text) {
+        size_t length = 1;
+        decodeCodePoint(text, length);
+        return length;
+    }
+};
+
+size_t svUtils::displayWidth(string_view text) {
+    return isAscii(text) ? AsciiText::width(text) : Utf8Text::width(text);
+}
+
+// Output of wrapToLength, collected in buffer and written to os in blocks if there is an os
+class WrapOutput {
+    public:
+        static constexpr size_t FLUSH_SIZE = size_t{ 1 } << 16;
+
+        WrapOutput(string& buffer, ostream* os) : buffer{ buffer }, os{ os } {}
+
+        void append(string_view text) {
+            buffer.append(text);
+            if (os && buffer.size() >= FLUSH_SIZE) flush();
+        }
+        void newLine(string_view indent) {
+            buffer += '\n';
+            append(indent);
+        }
+        void flush() {
+            if (!os || buffer.empty()) return;
+            os->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+
+    private:
+        string& buffer;
+        ostream* os;
+};
+
+// Positions wrapText works with, kept per thread so their capacity is reused
+struct WrapPositions {
+    DelimiterPositions window{};    //!< Positions in the window of lines being wrapped
+    DelimiterPositions delimiter{}; //!< Newlines of the delimiter itself
+};
+
+static WrapPositions& wrapPositions() {
+    thread_local WrapPositions positions{};
+    return positions;
+}
+
+static constexpr size_t WRAP_WINDOW_SIZE = size_t{ 1 } << 16;
+
+/**
+* One pass over lines: every word is split into line sized pieces of whole characters.
+* Words and their newlines come from the positions scanDelimiters finds in each window of lines;
+* a word which goes on past a window is added one piece per window.
+*/
+template <class Text>
+static void wrapText(
+    WrapOutput& output,
     string_view lines,
     const LineOptions& lineOptions
 ) {
-    if(lines.empty()) return;
-
     auto indent{lineOptions.indent};
     auto maxLineLength{lineOptions.maxLineLength};
     auto delimiter{lineOptions.delimiter};
-    auto startingPositionInLine{lineOptions.startingPositionInLine % maxLineLength };
-    
+    if(lines.empty() || 0 == maxLineLength) return;
+
     //Adjust indent side if longer than line length
-    if(indent.length() >= maxLineLength) indent = indent.substr(0, maxLineLength-1);
+    if(Text::width(indent) >= maxLineLength) indent = indent.substr(0, Text::fit(indent, maxLineLength-1).length);
+    size_t indentLength = Text::width(indent);
 
-    // Other Initializations
-    size_t indentLength = indent.length();
-    size_t delimiterLength = delimiter.length();
+    // Lines start at position 0, whatever startingPositionInLine is
+    size_t currentPositionInLine{0};
 
-    // Lambda to add a word till the end respecting the indent and newlines
+    // Lambda to add a word till the end respecting the indent and newlines.
+    // newLines are the positions of the word's '\n' counted from newLineOrigin bytes before the word
     auto addWord =
-        [&indent, &maxLineLength, &indentLength]
-        (ostream& os, string_view word, size_t& currentPositionInLine) {
-        string_view lettersToAdd, restOfWord;
-        auto remainingWordLength = word.length();
-        while (remainingWordLength > 0) {
-            // Check if Word is longer than remaining line
-            auto relativeLineEndPosition = maxLineLength - currentPositionInLine; // remaining characters in Line
-            if (relativeLineEndPosition == 0) {
-                os << '\n' << indent;
-                currentPositionInLine = indentLength;
-                continue;
-            }else if (remainingWordLength <= relativeLineEndPosition) {
-                // remaining word is shorter than line
-                lettersToAdd = word;
-                restOfWord = {};
-            }
-            else {
-                // remaining word is longer than line. Keep letters till end of line
-                lettersToAdd = word.substr(0, relativeLineEndPosition);
-                restOfWord = word.substr(relativeLineEndPosition);
+        [&output, &indent, &maxLineLength, &indentLength, &currentPositionInLine]
+        (string_view word, span<const size_t> newLines, size_t newLineOrigin) {
+        auto nextNewLine = [&newLines, &newLineOrigin]() {
+            return newLines.empty() ? string_view::npos : newLines.front() - newLineOrigin;
+        };
+        auto newLinePosition = nextNewLine();
+        while (!word.empty()) {
+            auto remainingInLine = currentPositionInLine < maxLineLength ? maxLineLength - currentPositionInLine : 0;
+            auto lettersToAdd = Text::fit(word, remainingInLine);
+            if (0 == lettersToAdd.length) {
+                if (remainingInLine < maxLineLength - indentLength) {
+                    output.newLine(indent);
+                    currentPositionInLine = indentLength;
+                    continue;
+                }
+                // A character wider than a new line would leave is added anyway
+                auto length = Text::firstCharacterLength(word);
+                lettersToAdd = { length, Text::width(word.substr(0, length)) };
             }
-            // Check for newlines in lettersToAdd
-            auto [lettersBeforeNewLine, lettersAfterNewLine] = splitByDelimiter(word, "\n");
-            if (lettersBeforeNewLine.length() < lettersToAdd.length()) {
-                // If new line is within lettersToAdd. Split at the newline character
-                os << lettersBeforeNewLine << '\n' << indent;
+            if (newLinePosition < lettersToAdd.length) {
+                // If new line is within the letters to add. Split at the newline character
+                output.append(word.substr(0, newLinePosition));
+                output.newLine(indent);
                 currentPositionInLine = indentLength;
-                word = lettersAfterNewLine;
+                word.remove_prefix(newLinePosition + 1);
+                newLineOrigin += newLinePosition + 1;
+                newLines = newLines.subspan(1);
+                newLinePosition = nextNewLine();
+            }else {
+                output.append(word.substr(0, lettersToAdd.length));
+                currentPositionInLine += lettersToAdd.columns;
+                word.remove_prefix(lettersToAdd.length);
+                newLineOrigin += lettersToAdd.length;
+                if (string_view::npos != newLinePosition) newLinePosition -= lettersToAdd.length;
             }
-            else {
-                // If no new line within letters to add, just add the letters
-                os << lettersToAdd;
-                currentPositionInLine += lettersToAdd.length();
-                word = restOfWord;
-            }
-            remainingWordLength = word.length();
         }
     };
 
+    auto& positions = wrapPositions();
+    scanDelimiters(delimiter, delimiter, positions.delimiter);
+    span<const size_t> delimiterNewLines{ positions.delimiter.newLines };
 
-    // Add Indent at the beginning
-    size_t currentPositionInLine{0};
-    string_view currentWord{}, restOfLines{lines};
-    if (startingPositionInLine > 0) {
-        auto currentword = (startingPositionInLine, ' ');
-        addWord(os, currentWord, currentPositionInLine);
-    }
-    while (restOfLines.length() > 0) {
-        std::tie(currentWord, restOfLines) = splitByDelimiter(restOfLines, delimiter);
-
-        // Add Word
-        addWord(os, currentWord, currentPositionInLine);
-        
-        // If delimiter is at start of line skip it
-        if (currentPositionInLine == indentLength) continue;
-        // If delimiter is at end of line skip it
-        if (currentPositionInLine == maxLineLength) continue;
-        // If this is the last word don't add delimiter
-        if (restOfLines.length() == 0) continue;
-        // Add Delimiter
-        addWord(os, delimiter, currentPositionInLine);
+    size_t added = 0; // Bytes of lines added, or dropped after a delimiter match, so far
+    for (size_t windowStart = 0; windowStart < lines.length();) {
+        auto windowEnd = std::min(lines.length(), windowStart + WRAP_WINDOW_SIZE);
+        // Keep the code point at the end of the window whole
+        for (int back = 0; back < 3 && windowEnd < lines.length() && 0x80 == (static_cast<unsigned char>(lines[windowEnd]) & 0xC0); ++back) --windowEnd;
+
+        // A match of a longer delimiter which starts in the window may end after it
+        auto overlap = delimiter.empty() ? 0 : delimiter.length() - 1;
+        scanDelimiters(lines.substr(windowStart, windowEnd - windowStart + overlap), delimiter, positions.window);
+
+        // Newlines of lines[from, to), which come after those of the previous word
+        const auto& newLines = positions.window.newLines;
+        size_t nextNewLine = 0;
+        auto newLinesOf = [&newLines, &nextNewLine, windowStart](size_t from, size_t to) {
+            while (nextNewLine < newLines.size() && windowStart + newLines[nextNewLine] < from) ++nextNewLine;
+            auto first = nextNewLine;
+            while (nextNewLine < newLines.size() && windowStart + newLines[nextNewLine] < to) ++nextNewLine;
+            return span<const size_t>{ newLines }.subspan(first, nextNewLine - first);
+        };
+
+        for (auto match : positions.window.delimiters) {
+            auto matchPosition = windowStart + match;
+            if (matchPosition >= windowEnd) break;
+
+            // Add Word
+            addWord(lines.substr(added, matchPosition - added), newLinesOf(added, matchPosition), added - windowStart);
+            // Only the first byte of the delimiter is dropped, as splitByDelimiter does
+            added = matchPosition + 1;
+
+            // If delimiter is at start of line skip it
+            if (currentPositionInLine == indentLength) continue;
+            // If delimiter is at end of line skip it
+            if (currentPositionInLine >= maxLineLength) continue;
+            // If this is the last word don't add delimiter
+            if (added == lines.length()) continue;
+            // Add Delimiter
+            addWord(delimiter, delimiterNewLines, 0);
+        }
+
+        // The rest of the window starts a word which goes on in the next window or ends lines
+        if (added < windowEnd) {
+            addWord(lines.substr(added, windowEnd - added), newLinesOf(added, windowEnd), added - windowStart);
+            added = windowEnd;
+        }
+        windowStart = windowEnd;
+    }
+}
+
+// Text without multibyte characters is wrapped without decoding it
+static void wrapInto(
+    WrapOutput& output,
+    string_view lines,
+    const LineOptions& lineOptions
+) {
+    if (isAscii(lines) && isAscii(lineOptions.indent) && isAscii(lineOptions.delimiter)) {
+        wrapText<AsciiText>(output, lines, lineOptions);
+    }else {
+        wrapText<Utf8Text>(output, lines, lineOptions);
     }
 }
+
+void svUtils::wrapToLength(
+    ostream& os,
+    string_view lines,
+    const LineOptions& lineOptions
+) {
+    thread_local string buffer{};
+    buffer.clear();
+    WrapOutput output{ buffer, &os };
+    wrapInto(output, lines, lineOptions);
+    output.flush();
+}
+
+void svUtils::wrapToLength(
+    string& output,
+    string_view lines,
+    const LineOptions& lineOptions
+) {
+    WrapOutput wrapOutput{ output, nullptr };
+    wrapInto(wrapOutput, lines, lineOptions);
+}
@@ -0,0 +1,85 @@
+/*********************************************************************
+ * @file  threadPool.cpp
+ *
+ * @brief Worker threads of ThreadPool and how they share a loop
+ *********************************************************************/
+
+#include "threadPool.h"
+#include <algorithm>
+
+namespace consoleMenu {
+    using std::lock_guard;
+    using std::unique_lock;
+}
+
+using namespace consoleMenu;
+
+// Chunks per thread: enough that threads which finish early take work from slower ones
+static constexpr size_t CHUNKS_PER_THREAD = 8;
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    threadCount = std::max<size_t>(threadCount, 1);
+    workers.reserve(threadCount - 1);
+    for (size_t worker = 1; worker < threadCount; ++worker) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard lock{ loopMutex };
+        stopping = true;
+    }
+    loopStarted.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::run(Loop& loop) {
+    loop.chunkSize = std::max<size_t>(loop.count / (size() * CHUNKS_PER_THREAD), 1);
+    if (!workers.empty()) {
+        {
+            lock_guard lock{ loopMutex };
+            currentLoop = &loop;
+            ++loopNumber;
+        }
+        loopStarted.notify_all();
+    }
+    work(loop);
+
+    unique_lock lock{ loopMutex };
+    // Workers which wake after this see no loop, so none can touch it once it returns
+    loopFinished.wait(lock, [this]() { return 0 == busyWorkers; });
+    currentLoop = nullptr;
+    if (loop.error) std::rethrow_exception(loop.error);
+}
+
+void ThreadPool::work(Loop& loop) {
+    while (true) {
+        auto begin = loop.next.fetch_add(loop.chunkSize);
+        if (begin >= loop.count) return;
+        try {
+            loop.body(begin, std::min(begin + loop.chunkSize, loop.count));
+        } catch (...) {
+            lock_guard lock{ loopMutex };
+            if (!loop.error) loop.error = std::current_exception();
+        }
+    }
+}
+
+void ThreadPool::workerLoop() {
+    size_t seenLoopNumber = 0;
+    unique_lock lock{ loopMutex };
+    while (true) {
+        loopStarted.wait(lock, [this, &seenLoopNumber]() { return stopping || loopNumber != seenLoopNumber; });
+        if (stopping) return;
+        seenLoopNumber = loopNumber;
+        if (!currentLoop) continue;
+
+        auto& loop = *currentLoop;
+        ++busyWorkers;
+        lock.unlock();
+        work(loop);
+        lock.lock();
+        if (0 == --busyWorkers) loopFinished.notify_all();
+    }
+}
@@ -1,4 +1,5 @@
 #include "userInput.h"
+#include "numberParser.h"
 #include <limits> 
 #include <string> 
 #include <stdexcept> 
@@ -41,18 +42,10 @@ template <typename T>
         { a >= b };
         { a <= b };
     }
-static bool isInRange(const T& number, T lowerBound, T upperBound) {
+static bool isInRange(const T& number, const T& lowerBound, const T& upperBound) {
     return (number >= lowerBound) and (number <= upperBound);
 }
 
-static void printInvalidInputMessage(
-    function<void()> callback,
-    ostream & os
-) {
-    os << "The input provided was invalid.\n";
-    callback();
-}
-
 template <typename T>
     requires is_integral_v<T> || is_floating_point_v<T>
 static string getDefaultRangePromptMessage(T lowerBound, T upperBound) {
@@ -69,118 +62,6 @@ static string getDefaultRangePromptMessage(IntegerString lowerBound, IntegerStri
         ")";
 }
 
-template <typename T>
-static T stringtoNumber(string_view numberString) {
-    if(!IntegerString::isInteger(numberString)){
-        throw "String is not a valid integral type";
-    };
-
-    if(std::is_unsigned_v<T> && IntegerString::isNegative(numberString)){
-        throw "String is not a valid unsigned type";
-    }
-
-    string maybeNumber{numberString};
-
-    // Unsigned number type
-    if (std::is_unsigned_v<T>) {
-        auto ullRepresentation = stoull(maybeNumber);
-        if (ullRepresentation > static_cast<unsigned long long>(numeric_limits<T>::max())) {
-            throw "String represents a number greater than the maximum allowed value for the type";
-        }
-        return static_cast<T>(ullRepresentation);
-    }
-        
-    auto llRepresentation = stoll(maybeNumber);
-    if (llRepresentation > static_cast<long long>(numeric_limits<T>::max())) {
-        throw "String represents a number greater than the maximum allowed value for the type";
-    }
-
-    if (llRepresentation < static_cast<long long>(numeric_limits<T>::min())) {
-        throw "String represents a number smaller than the minimum allowed value for the type";
-    }
-    
-    return static_cast<T>(llRepresentation);
-}
-
-template <>
-static int stringtoNumber(string_view numberString){
-    IntegerString intString{numberString};
-    if (!intString.valid()){ 
-        throw "String is not a valid integer";
-        return -999;
-    };
-    return stoi(move(string(numberString)));
-}
-
-template <>
-static double stringtoNumber(string_view numberString) {
-    return stod(move(string(numberString)));
-}
-
-template <>
-static IntegerString stringtoNumber(string_view numberString) {
-    IntegerString intString{ numberString };
-    if (!intString.valid()) {
-        throw "String is not a valid integer";
-    };
-    return intString;
-}
-
-//template <typename T>
-//optional<T> ioUtils::getNumberInRange(
-//    T lowerBound, 
-//    T upperBound, 
-//    string_view prompt, 
-//    istream& is, 
-//    ostream& os
-//){
-//    string defaultPrompt{};
-//    string_view promptView{prompt};
-//
-//    if(promptView.empty()) {
-//        defaultPrompt = move(getDefaultRangePromptMessage(lowerBound, upperBound));
-//        promptView = defaultPrompt;
-//    }
-//
-//    auto printPrompt =
-//        [&promptView, &os]() {
-//        os << promptView << '\n';
-//    };
-//
-//    printPrompt();
-//
-//    T number{};
-//    string numberString{};
-//    while (hasUnextractedInput(is)) // Loop until user enters a valid input
-//    {
-//        is >> numberString;
-//        if(!is){ // If the previous extraction failed
-//            resetInputStream(is);
-//            printInvalidInputMessage(printPrompt, os);
-//            continue;
-//        }
-//
-//        try{
-//            number = stringtoNumber<T>(numberString);
-//            if (!isInRange(number, lowerBound, upperBound)) { // Invalid input
-//                resetInputStream(is);
-//                printInvalidInputMessage(printPrompt, os);
-//                continue;
-//            }
-//        }catch(...){
-//            resetInputStream(is);
-//            printInvalidInputMessage(printPrompt, os);
-//            continue;
-//        }
-//
-//        ignoreInputLine(is); 
-//        
-//        return {number}; 
-//    }
-//
-//    return {};
-//}
-
 template <typename T>
 optional<T> 
 ioUtils::getNumberInRange(
@@ -213,58 +94,31 @@ ioUtils::getNumberInRange(
         os << "No valid number was provided.\n";
     };
    
-    return 
+    auto number =
         getValidInput
         (
-            function<void(ostream&)>(printPromptFunction),
-            function<void(ostream&)>(printInvalidInputMessage),
-            function<void(ostream&)>(printErrorMessage),
-            isAlwaysValidInput(),
-            tuple<>{},
-            function<T(string_view)>(stringtoNumber<T>),
-            tuple<>{},
-            function<bool(const T&, T, T)>(isInRange<T>),
-            tuple<T, T>{lowerBound, upperBound},
+            printPromptFunction,
+            printInvalidInputMessage,
+            printErrorMessage,
+            [](string_view) { return true; },
+            parseNumber<T>,
+            [&lowerBound, &upperBound](const optional<T>& number) {
+                return number.has_value() && isInRange(number.value(), lowerBound, upperBound);
+            },
             is,
             os
         );
+    if (!number) return {};
+    return number.value();
 }
 
-void fn(
-    string_view prompt, 
-    istream& is, 
-    ostream& os
-){
-    auto printPromptFunction = [&prompt](ostream& os){os << prompt << '\n'; };
-    auto printInvalidInputMessage = [](ostream& os){os << "The input provided was invalid.\n";};
-    auto printErrorMessage = [](ostream& os){os << "NoValid input was provided.\n";};
-    auto isValidInputString = 
-        [](string_view sv, size_t minlen, size_t maxlen) {
-            return (sv.length() >= minlen && sv.length() <= maxlen);
-        };
-
-    auto convertStringToOutput = 
-        [](string_view sv)-> int{
-            return stoi(move(string{sv}));
-        };
-    
-    //auto dontCheckOutput = [](const int& x)->bool{return true;};
-
-    int x = getValidInput(
-        printPromptFunction,
-        printInvalidInputMessage,
-        printErrorMessage,
-        isAlwaysValidInput(),
-        make_tuple<>(),
-        function(convertStringToOutput),
-        make_tuple<>(),
-        isAlwaysValidOutput<int>(),
-        make_tuple<>()
-    ).value_or(-999);
+string& ioUtils::inputTokenBuffer() {
+    thread_local string buffer{};
+    return buffer;
 }
 
 std::function<bool(string_view)> ioUtils::isAlwaysValidInput() {
-    return function([](string_view sv) { return true; });
+    return function([](string_view) { return true; });
 };
 
 
@@ -0,0 +1,27 @@
+/*********************************************************************
+ * @file  allocationCounter.cpp
+ *
+ * @brief Replacement global operator new and delete behind allocationCounter.h.
+ *        They live in their own translation unit so the compiler does not
+ *        pair the malloc and free inside them with new expressions elsewhere
+ *********************************************************************/
+
+#include "allocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+std::atomic<bool> allocationCounter::countAllocations{ false };
+std::atomic<size_t> allocationCounter::allocationCount{ 0 };
+
+void* operator new(std::size_t size) {
+    if (allocationCounter::countAllocations) ++allocationCounter::allocationCount;
+    if (void* memory = std::malloc(size > 0 ? size : 1)) return memory;
+    throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
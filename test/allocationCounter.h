@@ -0,0 +1,16 @@
+#pragma once
+/*********************************************************************
+ * @file  allocationCounter.h
+ *
+ * @brief Counts heap allocations made by the test executable while
+ *        countAllocations is set
+ *
+ *********************************************************************/
+
+#include <atomic>
+#include <cstddef>
+
+namespace allocationCounter {
+    extern std::atomic<bool> countAllocations;
+    extern std::atomic<size_t> allocationCount;
+}
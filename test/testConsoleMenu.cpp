@@ -2,8 +2,23 @@
 #include "osUtils.h"
 #include "ioUtils.h"
 #include "svUtils.h"
+#include "consoleMenu.h"
+#include "menuSnapshot.h"
+#include "allocationCounter.h"
 #include <string>
 #include <sstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#if defined(__linux__)
+    #include "menuServer.h"
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+#endif
 
 using osUtils::OS;
 using osUtils::clearScreen;
@@ -11,9 +26,16 @@ using ioUtils::getNumberInRange;
 using ioUtils::IntegerString;
 using DigitInString = IntegerString::DigitInString;
 using std::string;
+using std::string_view;
 using std::stringstream;
 using std::istringstream;
 using std::ostringstream;
+using consoleMenu::Menu;
+using consoleMenu::PooledMenu;
+using consoleMenu::MenuItem;
+using consoleMenu::MenuContents;
+using allocationCounter::countAllocations;
+using allocationCounter::allocationCount;
 
 TEST(TestosUtils, TestOS) {
     #if defined(_WIN64)
@@ -33,10 +55,91 @@ TEST(TestosUtils, TestOS) {
     #endif
 }   
 
+TEST(TestosUtils, TestclearScreen) {
+    ostringstream ostrstream{};
+    EXPECT_TRUE(clearScreen(ostrstream));
+    EXPECT_EQ(ostrstream.str(), "\x1b[H\x1b[2J");
+    EXPECT_FALSE(osUtils::isTerminal(ostrstream));
+}
+
+TEST(TestosUtils, TestdecodeKey) {
+    using osUtils::Key;
+    using osUtils::KeyPress;
+    using osUtils::decodeKey;
+    KeyPress keyPress{};
+    EXPECT_EQ(decodeKey("7", keyPress), 1u);
+    EXPECT_EQ(keyPress, (KeyPress{ Key::Character, '7' }));
+    EXPECT_EQ(decodeKey("\r", keyPress), 1u);
+    EXPECT_EQ(keyPress.key, Key::Enter);
+    EXPECT_EQ(decodeKey("\x1b[A1", keyPress), 3u);
+    EXPECT_EQ(keyPress.key, Key::Up);
+    EXPECT_EQ(decodeKey("\x1bOH", keyPress), 3u);
+    EXPECT_EQ(keyPress.key, Key::Home);
+    EXPECT_EQ(decodeKey("\x1b[4~", keyPress), 4u);
+    EXPECT_EQ(keyPress.key, Key::End);
+    EXPECT_EQ(decodeKey("\x1b[1;5C", keyPress), 6u);
+    EXPECT_EQ(keyPress.key, Key::Right);
+    EXPECT_EQ(decodeKey("\x1b[", keyPress), 0u); // Rest of the sequence not read yet
+    EXPECT_EQ(decodeKey("\x1b", keyPress), 0u);
+    EXPECT_EQ(decodeKey("\x1bq", keyPress), 2u); // Alt+q must not quit
+    EXPECT_EQ(keyPress.key, Key::None);
+    EXPECT_EQ(decodeKey("\x1b\x1b[A", keyPress), 1u);
+    EXPECT_EQ(keyPress.key, Key::Escape);
+    EXPECT_EQ(decodeKey("\x7f", keyPress), 1u);
+    EXPECT_EQ(keyPress.key, Key::Backspace);
+}
+
 TEST(TestioUtils, TestIntegerString) {
     EXPECT_TRUE(IntegerString {"-0000007699806578356817" } < IntegerString{ "+000007" });
     EXPECT_TRUE(IntegerString{ "0" } == IntegerString{ "0000000000000" });
+    EXPECT_TRUE(IntegerString{ "-0" } == IntegerString{ "0" });
+    EXPECT_TRUE(IntegerString{ "1000000000000000000" } > IntegerString{ "999999999999999999" });
+    EXPECT_TRUE(IntegerString{ "-1000000000000000000" } < IntegerString{ "-999999999999999999" });
+    EXPECT_EQ(IntegerString{ "+000123000000000456" }.toString(), "123000000000456");
+    EXPECT_FALSE(IntegerString{ "12a" }.valid());
+    EXPECT_FALSE(IntegerString{ "12a" } == IntegerString{ "12a" });
+    EXPECT_FALSE(IntegerString{} == IntegerString{ "x" });
+
+    IntegerString large{ "123456789012345678901234567890" };
+    EXPECT_EQ((large + IntegerString{ "876543210987654321098765432110" }).toString(), "1000000000000000000000000000000");
+    EXPECT_EQ((large - large).toString(), "0");
+    EXPECT_EQ((IntegerString{ "5" } - large).toString(), "-123456789012345678901234567885");
+    EXPECT_EQ((IntegerString{ "-999999999" } - IntegerString{ "1" }).toString(), "-1000000000");
+    EXPECT_EQ((large * IntegerString{ "-1000000000" }).toString(), "-123456789012345678901234567890000000000");
+    EXPECT_EQ((large * large).toString(), "15241578753238836750495351562536198787501905199875019052100");
+    EXPECT_FALSE((large + IntegerString{}).valid());
 }
+TEST(TestioUtils, TestscanIntegerTokens) {
+    using ioUtils::IntegerToken;
+    using ioUtils::ScanPath;
+    EXPECT_FALSE(IntegerString::isInteger(""));
+
+    std::vector<IntegerToken> tokens{};
+    ioUtils::scanIntegerTokens(" 12,-3\t+\n4a -0 ", tokens);
+    EXPECT_EQ(tokens, (std::vector<IntegerToken>{ { 1, 2, true }, { 4, 2, true }, { 7, 1, false }, { 9, 2, false }, { 12, 2, true } }));
+
+    // Tokens of every length cross the 64 byte blocks; every path has to agree with isInteger
+    string input{};
+    for (int index = 0; index < 2000; ++index) {
+        if (0 == index % 11) input += '-';
+        input += std::to_string(static_cast<long long>(index) * index * 7919);
+        if (0 == index % 13) input += 'x';
+        input += 0 == index % 5 ? ",\r\n" : " ";
+    }
+    input += "+";
+    std::vector<IntegerToken> expected{};
+    constexpr string_view separators = " ,\t\n\v\f\r";
+    for (auto start = input.find_first_not_of(separators); start != string::npos; start = input.find_first_not_of(separators, start)) {
+        auto end = std::min(input.find_first_of(separators, start), input.size());
+        expected.push_back({ start, end - start, IntegerString::isInteger(string_view{ input }.substr(start, end - start)) });
+        start = end;
+    }
+    for (auto path : { ScanPath::Scalar, ScanPath::SSE2, ScanPath::AVX2 }) {
+        ioUtils::scanIntegerTokens(input, tokens, path);
+        EXPECT_EQ(tokens, expected);
+    }
+}
+
 TEST(TestsvUtils, TestwrapToLength) {
     
     stringstream ostrstream{};
@@ -57,17 +160,76 @@ TEST(TestsvUtils, TestwrapToLength) {
         "   gibberish"
     };
 
-    svUtils::wrapToLength(
-        ostrstream,
-        "string_view lines there is a a very long line \n.Something elsecanbedone thisisaverylongcontiguouswordwithoutadelimiter then thereare three newlines\n \n\nfollowedbysomelongibberish ",
-        {
-            "   ",
-            20,
-            " ",
-            3
-        }
-    );
+    string_view lines{ "string_view lines there is a a very long line \n.Something elsecanbedone thisisaverylongcontiguouswordwithoutadelimiter then thereare three newlines\n \n\nfollowedbysomelongibberish " };
+    svUtils::LineOptions lineOptions{
+        "   ",
+        20,
+        " ",
+        3
+    };
+    svUtils::wrapToLength(ostrstream, lines, lineOptions);
     EXPECT_EQ(ostrstream.str(), expectedString);
+
+    string appended{ ">" };
+    svUtils::wrapToLength(appended, lines, lineOptions);
+    EXPECT_EQ(appended, ">" + expectedString);
+
+    // A word longer than several lines is split at every line end and at its newline
+    string longWord{};
+    svUtils::wrapToLength(longWord, string(25, 'x') + "\ny", { "  ", 10 });
+    EXPECT_EQ(longWord, "xxxxxxxxxx\n  xxxxxxxx\n  xxxxxxx\n  y");
+}
+
+TEST(TestsvUtils, TestscanDelimiters) {
+    using svUtils::ScanPath;
+    string text{};
+    for (int index = 0; index < 300; ++index) text += (index % 7 == 0) ? "\n" : (index % 5 == 0) ? ", " : (index % 3 == 0) ? " " : "ab";
+    text += ",,,";
+
+    for (string_view delimiter : { " ", ", ", ",,", "\n" }) {
+        // Every match, overlapping ones included, is where splitByDelimiter splits
+        svUtils::DelimiterPositions expected{};
+        for (auto position = text.find(delimiter); string::npos != position; position = text.find(delimiter, position + 1)) {
+            expected.delimiters.push_back(position);
+        }
+        for (auto position = text.find('\n'); string::npos != position; position = text.find('\n', position + 1)) {
+            expected.newLines.push_back(position);
+        }
+        for (auto path : { ScanPath::Scalar, ScanPath::SSE2, ScanPath::AVX2 }) {
+            svUtils::DelimiterPositions positions{};
+            svUtils::scanDelimiters(text, delimiter, positions, path);
+            EXPECT_EQ(positions.delimiters, expected.delimiters);
+            EXPECT_EQ(positions.newLines, expected.newLines);
+        }
+    }
+
+    svUtils::DelimiterPositions positions{};
+    svUtils::scanDelimiters("abc", "", positions);
+    EXPECT_EQ(positions.delimiters, std::vector<size_t>({ 0, 1, 2 }));
+}
+
+TEST(TestsvUtils, TestdisplayWidth) {
+    EXPECT_EQ(svUtils::displayWidth("abc"), 3u);
+    EXPECT_EQ(svUtils::displayWidth("caf\xC3\xA9"), 4u);        // Precomposed e acute
+    EXPECT_EQ(svUtils::displayWidth("cafe\xCC\x81"), 4u);       // e and a combining acute accent
+    EXPECT_EQ(svUtils::displayWidth("\xE6\xBC\xA2\xE5\xAD\x97"), 4u); // Two CJK ideographs
+    EXPECT_EQ(svUtils::displayWidth("\xE2\x94\x80\xE2\x94\xBC"), 2u); // Box drawing
+    EXPECT_EQ(svUtils::displayWidth("\xF0\x9F\x98\x80"), 2u);   // Emoji
+    EXPECT_EQ(svUtils::displayWidth("\xFF\xE6\xBC"), 3u);        // One column per byte of invalid and truncated sequences
+    string ascii(100, 'a');
+    EXPECT_TRUE(svUtils::isAscii(ascii));
+    ascii[70] = '\xC3';
+    EXPECT_FALSE(svUtils::isAscii(ascii));
+
+    // Wide characters fill lines by columns and are never split
+    string wrapped{};
+    svUtils::wrapToLength(wrapped, "\xE6\xBC\xA2\xE5\xAD\x97\xE6\xBC\xA2\xE5\xAD\x97\xE6\xBC\xA2 ab", { "  ", 6 });
+    EXPECT_EQ(wrapped, "\xE6\xBC\xA2\xE5\xAD\x97\xE6\xBC\xA2\n  \xE5\xAD\x97\xE6\xBC\xA2\n  ab");
+
+    // A combining mark stays on the line of its letter
+    wrapped.clear();
+    svUtils::wrapToLength(wrapped, "abcde\xCC\x81" "f", { "", 5 });
+    EXPECT_EQ(wrapped, "abcde\xCC\x81\nf");
 }
 
 TEST(TestuserInput, TestgetNumberInRange) {
@@ -96,4 +258,817 @@ TEST(TestuserInput, TestgetNumberInRange) {
     optionalIntInput = getNumberInRange<unsigned short>(-1, 3, "Choose an option from -1 to 3", istrstream, ostrstream);
     ASSERT_TRUE(optionalIntInput.has_value());
     ASSERT_EQ(optionalIntInput.value(), 3);
-}
\ No newline at end of file
+}
+
+TEST(TestuserInput, TestparseNumber) {
+    using ioUtils::parseNumber;
+    EXPECT_EQ(parseNumber<int>("-42"), -42);
+    EXPECT_EQ(parseNumber<int>("+007"), 7);
+    EXPECT_FALSE(parseNumber<int>("2.5").has_value());
+    EXPECT_FALSE(parseNumber<int>("").has_value());
+    EXPECT_FALSE(parseNumber<int>("+-1").has_value());
+    EXPECT_FALSE(parseNumber<int>("99999999999").has_value());
+    EXPECT_EQ(parseNumber<unsigned short>("65535"), 65535);
+    EXPECT_FALSE(parseNumber<unsigned short>("65536").has_value());
+    EXPECT_FALSE(parseNumber<unsigned short>("-0").has_value());
+    EXPECT_EQ(parseNumber<double>("2.5e1"), 25.0);
+    EXPECT_FALSE(parseNumber<double>("2.5x").has_value());
+    EXPECT_EQ(parseNumber<IntegerString>("-12"), IntegerString{ "-12" });
+    EXPECT_EQ(parseNumber<IntegerString>("123456789012345678901234567890"), IntegerString{ "123456789012345678901234567890" });
+    EXPECT_FALSE(parseNumber<IntegerString>("12a").has_value());
+}
+
+template <class MenuType>
+static void addTestMenuItems(MenuType& menu) {
+    menu.addChildNodeAtPath({}, { "File" });
+    menu.addChildNodeAtPath({}, { "Edit" });
+    menu.addChildNodeAtPath({}, { "Help" });
+    menu.addChildNodeAtPath(std::vector<unsigned short>{ 0 }, { "Open" });
+    menu.addChildNodeAtPath(std::vector<unsigned short>{ 0 }, { "Save" });
+    menu.addChildNodeAtPath(std::vector<unsigned short>{ 1 }, { "Undo" });
+}
+
+TEST(TestconsoleMenu, TestPooledMenu) {
+    Menu menu{};
+    PooledMenu pooledMenu{};
+    addTestMenuItems(menu);
+    addTestMenuItems(pooledMenu);
+
+    EXPECT_EQ(pooledMenu.tree.size(), 7u);
+    EXPECT_EQ(menu.root().children.size(), 3u);
+    EXPECT_EQ(menu.root().nodeAtRelativePath(std::vector<unsigned short>{ 1, 0 }).value().get().contents().brief, "Undo");
+    EXPECT_FALSE(pooledMenu.addChildNodeAtPath(std::vector<unsigned short>{ 5 }, { "Missing" }).has_value());
+
+    for (const auto& path : std::vector<std::vector<unsigned short>>{ {}, { 0 }, { 1 }, { 2 } }) {
+        ostringstream menuStream{}, pooledMenuStream{};
+        menu.getMenuFromRootPath(menuStream, path);
+        pooledMenu.getMenuFromRootPath(pooledMenuStream, path);
+        EXPECT_EQ(menuStream.str(), pooledMenuStream.str());
+    }
+
+    ostringstream menuStream{}, pooledMenuStream{};
+    std::vector<unsigned short> fromPath{ 0 }, toPath{ 1 };
+    menu.changeMenu(menuStream, fromPath, toPath);
+    pooledMenu.changeMenu(pooledMenuStream, fromPath, toPath);
+    EXPECT_EQ(pooledMenuStream.str(), "\n1. File\n2. Edit\n1. Undo\n3. Help");
+    EXPECT_EQ(menuStream.str(), pooledMenuStream.str());
+}
+
+TEST(TestconsoleMenu, TestdrawFrameIncrementally) {
+    Menu menu{};
+    ostringstream firstFrameStream{}, secondFrameStream{};
+
+    menu.drawFrameIncrementally(firstFrameStream, "\n1. File\n2. Edit");
+    EXPECT_EQ(
+        firstFrameStream.str(),
+        "\x1b[1;1H\x1b[J"
+        "\x1b[1;1H\x1b[K\x1b[2;1H1. File\x1b[K\x1b[3;1H2. Edit\x1b[K"
+        "\x1b[4;1H\x1b[J\x1b[3;8H"
+    );
+
+    // Only the inserted line and the lines after it are rewritten
+    menu.drawFrameIncrementally(secondFrameStream, "\n1. File\n1. Open\n2. Edit");
+    EXPECT_EQ(
+        secondFrameStream.str(),
+        "\x1b[3;1H1. Open\x1b[K\x1b[4;1H2. Edit\x1b[K"
+        "\x1b[5;1H\x1b[J\x1b[4;8H"
+    );
+}
+
+template <class MenuType>
+static void testLayoutCache(MenuType& menu) {
+    addTestMenuItems(menu);
+    std::vector<unsigned short> path{ 0 };
+
+    ostringstream firstRender{}, secondRender{}, thirdRender{};
+    menu.getMenuFromRootPath(firstRender, path);
+    EXPECT_EQ(menu.layoutCacheStats().hits, 0u);
+    EXPECT_EQ(menu.layoutCacheStats().misses, 5u);
+
+    menu.getMenuFromRootPath(secondRender, path);
+    EXPECT_EQ(menu.layoutCacheStats().hits, 5u);
+    EXPECT_EQ(menu.layoutCacheStats().misses, 5u);
+    EXPECT_EQ(firstRender.str(), secondRender.str());
+
+    menu.resetLayoutCacheStats();
+    auto openNode = menu.tree.nodeAtRelativePath(menu.tree.rootNode(), std::vector<unsigned short>{ 0, 0 }).value();
+    if constexpr (std::is_same_v<MenuType, Menu>) {
+        openNode.get().setContents({ "Open File" });
+    } else {
+        menu.tree.setContents(openNode, { "Open File" });
+    }
+    menu.getMenuFromRootPath(thirdRender, path);
+    EXPECT_EQ(menu.layoutCacheStats().hits, 4u);
+    EXPECT_EQ(menu.layoutCacheStats().misses, 1u);
+    EXPECT_EQ(thirdRender.str(), "\n1. File\n1. Open File\n2. Save\n2. Edit\n3. Help");
+}
+
+TEST(TestconsoleMenu, TestLayoutCache) {
+    Menu menu{};
+    testLayoutCache(menu);
+    PooledMenu pooledMenu{};
+    testLayoutCache(pooledMenu);
+}
+
+template <class MenuType>
+static void testPreLayoutBriefs(MenuType& menu, MenuType& lazilyLaidOutMenu) {
+    for (auto* target : { &menu, &lazilyLaidOutMenu }) {
+        addTestMenuItems(*target);
+        target->addChildNodeAtPath(std::vector<unsigned short>{ 0, 1 }, { "Save a copy of the open file under a new name" }, { .briefIndentSpaces{ 4 }, .maxLineLength{ 20 } });
+        for (unsigned short item = 1; item <= 40; ++item) {
+            target->addChildNodeAtPath(std::vector<unsigned short>{ 2 }, { "Topic " + std::to_string(item) });
+        }
+    }
+    consoleMenu::ThreadPool pool{ 3 };
+    menu.preLayoutBriefs(pool);
+    EXPECT_EQ(menu.layoutCacheStats().misses, 0u);
+
+    for (const auto& path : { std::vector<unsigned short>{ 0, 1 }, std::vector<unsigned short>{ 2 } }) {
+        ostringstream render{}, lazyRender{};
+        menu.getMenuFromRootPath(render, path);
+        lazilyLaidOutMenu.getMenuFromRootPath(lazyRender, path);
+        EXPECT_EQ(render.str(), lazyRender.str());
+    }
+    EXPECT_EQ(menu.layoutCacheStats().misses, 0u);
+    EXPECT_EQ(menu.layoutCacheStats().hits, lazilyLaidOutMenu.layoutCacheStats().hits + lazilyLaidOutMenu.layoutCacheStats().misses);
+}
+
+TEST(TestconsoleMenu, TestPreLayoutBriefs) {
+    Menu menu{}, lazilyLaidOutMenu{};
+    testPreLayoutBriefs(menu, lazilyLaidOutMenu);
+    PooledMenu pooledMenu{}, lazilyLaidOutPooledMenu{};
+    testPreLayoutBriefs(pooledMenu, lazilyLaidOutPooledMenu);
+}
+
+template <class MenuType>
+static string renderPagedMenu(MenuType& menu, const std::vector<unsigned short>& path) {
+    for (unsigned short item = 1; item <= 25; ++item) {
+        menu.addChildNodeAtPath({}, { "Entry " + std::to_string(item) });
+    }
+    menu.addChildNodeAtPath(std::vector<unsigned short>{ 12 }, { "Child" });
+    menu.viewport = { .size{ 10 }, .start{ 0 } };
+
+    ostringstream ostrstream{};
+    menu.getMenuFromRootPath(ostrstream, path);
+    return ostrstream.str();
+}
+
+TEST(TestconsoleMenu, TestViewport) {
+    Menu menu{};
+    PooledMenu pooledMenu{};
+    std::vector<unsigned short> path{ 12 };
+    auto paged = renderPagedMenu(menu, path);
+
+    string expected{};
+    for (int item = 11; item <= 20; ++item) {
+        expected += "\n" + std::to_string(item) + ". Entry " + std::to_string(item);
+        if (13 == item) expected += "\n1. Child";
+    }
+    expected += "\n[11-20 of 25]";
+    EXPECT_EQ(paged, expected);
+    EXPECT_EQ(renderPagedMenu(pooledMenu, path), expected);
+
+    // Page forward from the root to the last, partially filled, page
+    istringstream istrstream{ "n\nn\nn\nq\n" };
+    ostringstream ostrstream{};
+    menu.currentMenuPath.clear();
+    menu.displayMenu(istrstream, ostrstream);
+    EXPECT_NE(ostrstream.str().find("\n21. Entry 21"), string::npos);
+    EXPECT_NE(ostrstream.str().find("[21-25 of 25]"), string::npos);
+    EXPECT_NE(ostrstream.str().find("There are no more pages"), string::npos);
+}
+
+template <class MenuType>
+static void testSearch(MenuType& menu) {
+    using Path = std::vector<unsigned short>;
+    addTestMenuItems(menu);
+
+    EXPECT_EQ(menu.findNode("sav"), Path({ 0, 1 }));
+    EXPECT_EQ(menu.findNode("AVE"), Path({ 0, 1 }));
+    EXPECT_EQ(menu.findNode("ed"), Path({ 1 }));
+    EXPECT_FALSE(menu.findNode("it").has_value()); // Two characters only match the start of a word
+    EXPECT_FALSE(menu.findNode("xyz").has_value());
+
+    menu.addChildNodeAtPath(Path{ 1 }, { "Redo last edit" });
+    EXPECT_EQ(menu.findNode("last"), Path({ 1, 1 }));
+
+    istringstream istrstream{ "/undo\nq\n" };
+    ostringstream ostrstream{};
+    menu.displayMenu(istrstream, ostrstream);
+    EXPECT_EQ(menu.currentMenuPath, Path({ 1, 0 }));
+    EXPECT_NE(ostrstream.str().find("\n1. Undo\n2. Redo last edit"), string::npos);
+}
+
+TEST(TestconsoleMenu, TestSearch) {
+    Menu menu{};
+    testSearch(menu);
+    PooledMenu pooledMenu{};
+    testSearch(pooledMenu);
+
+    auto helpNode = menu.tree.nodeAtRelativePath(menu.tree.rootNode(), std::vector<unsigned short>{ 2 }).value();
+    helpNode.get().setContents({ "About" });
+    EXPECT_FALSE(menu.findNode("about").has_value());
+    menu.rebuildSearchIndex();
+    EXPECT_EQ(menu.findNode("about"), std::vector<unsigned short>({ 2 }));
+    EXPECT_EQ(menu.findNode("redo"), std::vector<unsigned short>({ 1, 1 }));
+}
+
+
+template <class MenuType>
+static void testCursor(MenuType& menu) {
+    addTestMenuItems(menu);
+    auto briefAtCursor = [&menu]() { return menu.tree.contents(menu.currentNode()).brief; };
+
+    EXPECT_TRUE(menu.selectChild(0));
+    EXPECT_TRUE(menu.selectChild(1));
+    EXPECT_EQ(briefAtCursor(), "Save");
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 0, 1 }));
+    EXPECT_FALSE(menu.selectChild(0)); // Save has no children
+
+    EXPECT_TRUE(menu.goBack());
+    EXPECT_EQ(briefAtCursor(), "File");
+    EXPECT_TRUE(menu.goBack());
+    EXPECT_FALSE(menu.goBack());
+    EXPECT_EQ(menu.cursor.size(), 1u);
+
+    menu.navigateTo(std::vector<unsigned short>{ 1, 0 });
+    EXPECT_EQ(briefAtCursor(), "Undo");
+    menu.navigateTo(std::vector<unsigned short>{ 2, 5 });
+    EXPECT_TRUE(menu.currentMenuPath.empty());
+
+    istringstream istrstream{ "1\n2\nb\nb\n2\nq\n" };
+    ostringstream ostrstream{};
+    menu.displayMenu(istrstream, ostrstream);
+    EXPECT_EQ(briefAtCursor(), "Edit");
+    EXPECT_TRUE(ostrstream.str().ends_with("\n1. File\n2. Edit\n1. Undo\n3. Help" + string(menu.userPrompt())));
+}
+
+TEST(TestconsoleMenu, TestTypeahead) {
+    PooledMenu menu{};
+    addTestMenuItems(menu);
+
+    // A route which fails part way is rejected as a whole and nothing in between is rendered
+    istringstream istrstream{ "1 9\n 1 2 b b 2  1 \nq\n" };
+    ostringstream ostrstream{};
+    menu.displayMenu(istrstream, ostrstream);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+    string prompt{ menu.userPrompt() };
+    EXPECT_EQ(ostrstream.str(),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        string(menu.userOptionInvalid()) + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt);
+
+    EXPECT_EQ(menu.applyUserInput("b b b"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(menu.applyUserInput("1 q"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(menu.applyUserInput("b 0"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(menu.applyUserInput("1 0"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+    EXPECT_EQ(menu.applyUserInput("b b 1 2"), consoleMenu::OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 0, 1 }));
+
+    // Options are still read from an istream through its adapter
+    istringstream optionStream{ "x\nb 2\n" };
+    ostringstream promptStream{};
+    auto option = menu.getValidUserOption(optionStream, promptStream);
+    ASSERT_TRUE(option.has_value());
+    EXPECT_EQ(std::get<PooledMenu::OptionRoute>(option.value()).steps.size(), 2u);
+}
+
+TEST(TestconsoleMenu, TestCursor) {
+    Menu menu{};
+    testCursor(menu);
+    PooledMenu pooledMenu{};
+    testCursor(pooledMenu);
+}
+
+template <class MenuType>
+static void testUserHiddenNodes(MenuType& menu) {
+    addTestMenuItems(menu);
+    auto editNode = menu.tree.nodeAtRelativePath(menu.tree.rootNode(), std::vector<unsigned short>{ 1 }).value();
+    if constexpr (std::is_same_v<MenuType, Menu>) {
+        editNode.get().hide();
+    } else {
+        menu.tree.hide(editNode);
+    }
+
+    // Hidden nodes stay hidden across navigation and keep their item number
+    for (const auto& path : std::vector<std::vector<unsigned short>>{ { 0 }, {}, { 0 } }) {
+        ostringstream ostrstream{};
+        menu.getMenuFromRootPath(ostrstream, path);
+        EXPECT_EQ(ostrstream.str(), path.empty() ? "\n1. File\n3. Help" : "\n1. File\n1. Open\n2. Save\n3. Help");
+    }
+}
+
+TEST(TestconsoleMenu, TestUserHiddenNodes) {
+    Menu menu{};
+    testUserHiddenNodes(menu);
+    PooledMenu pooledMenu{};
+    testUserHiddenNodes(pooledMenu);
+}
+template <class MenuType>
+static void testLazyChildren(MenuType& menu) {
+    addTestMenuItems(menu);
+    size_t fileCalls = 0;
+    size_t editCalls = 0;
+    auto countingProvider = [](size_t& calls, const string& prefix) {
+        return [&calls, prefix]() {
+            ++calls;
+            std::vector<MenuItem> items{};
+            for (int i = 1; i <= 3; ++i) items.push_back({ MenuContents{ prefix + " " + std::to_string(i), {} }, {} });
+            return items;
+        };
+    };
+    menu.setChildProvider(std::vector<unsigned short>{ 0 }, countingProvider(fileCalls, "Recent"));
+    menu.setChildProvider(std::vector<unsigned short>{ 1 }, countingProvider(editCalls, "Clipboard"));
+    EXPECT_EQ(fileCalls, 0u);
+
+    // Children are provided once and kept across visits
+    for (int visit = 0; visit < 3; ++visit) {
+        menu.navigateTo(std::vector<unsigned short>{ 0 });
+        menu.goBack();
+    }
+    EXPECT_EQ(fileCalls, 1u);
+    ostringstream ostrstream{};
+    menu.getMenuFromRootPath(ostrstream, std::vector<unsigned short>{ 0 });
+    EXPECT_EQ(ostrstream.str(), "\n1. File\n1. Recent 1\n2. Recent 2\n3. Recent 3\n2. Edit\n3. Help");
+
+    // Over budget, expanding Edit evicts File which is provided again on the next visit
+    menu.lazyChildBudget = 4;
+    menu.navigateTo(std::vector<unsigned short>{ 1 });
+    EXPECT_EQ(editCalls, 1u);
+    EXPECT_EQ(menu.lazyChildrenInMemory(), 3u);
+    EXPECT_EQ(menu.tree.childCount(menu.tree.nodeAtRelativePath(menu.tree.rootNode(), std::vector<unsigned short>{ 0 }).value()), 0u);
+    EXPECT_TRUE(menu.selectChild(0)); // The current path is never evicted
+    EXPECT_EQ(menu.tree.contents(menu.currentNode()).brief, "Clipboard 1");
+
+    menu.navigateTo(std::vector<unsigned short>{ 0, 2 });
+    EXPECT_EQ(fileCalls, 2u);
+    EXPECT_EQ(menu.tree.contents(menu.currentNode()).brief, "Recent 3");
+    EXPECT_EQ(menu.lazyChildrenInMemory(), 3u);
+
+    // A route is checked without expanding anything, so only following it calls a provider
+    EXPECT_EQ(menu.applyUserInput("b b 2 1"), consoleMenu::OptionOutcome::Moved);
+    EXPECT_EQ(menu.tree.contents(menu.currentNode()).brief, "Clipboard 1");
+    EXPECT_EQ(editCalls, 2u);
+    EXPECT_EQ(fileCalls, 2u);
+    EXPECT_EQ(menu.applyUserInput("b b 3 1"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(menu.applyUserInput("b 9"), consoleMenu::OptionOutcome::InvalidOption);
+    EXPECT_EQ(editCalls, 2u);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+}
+
+TEST(TestconsoleMenu, TestLazyChildren) {
+    Menu menu{};
+    testLazyChildren(menu);
+    PooledMenu pooledMenu{};
+    testLazyChildren(pooledMenu);
+}
+
+template <class MenuType>
+static void testSteadyStateAllocations(MenuType& menu) {
+    struct NullBuffer : std::streambuf {
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+        int overflow(int c) override { return c; }
+    } nullBuffer{};
+    std::ostream os{ &nullBuffer };
+    addTestMenuItems(menu);
+    menu.viewport.size = 2;
+    std::vector<unsigned short> undoPath{ 1, 0 };
+
+    auto navigate = [&menu, &os, &undoPath]() {
+        menu.resetCursor();
+        menu.selectChild(0);
+        menu.getMenuFromRootPath(os, menu.currentMenuPath);
+        menu.selectChild(1);
+        menu.drawFrameIncrementally(os, menu.renderFrame(menu.currentMenuPath));
+        menu.goBack();
+        menu.goBack();
+        menu.drawFrameIncrementally(os, menu.renderFrame(menu.currentMenuPath));
+        menu.navigateTo(undoPath);
+        menu.drawFrameIncrementally(os, menu.renderFrame(menu.currentMenuPath));
+    };
+
+    navigate(); // Lays out every brief and sizes the buffers
+    allocationCount = 0;
+    countAllocations = true;
+    for (int repeat = 0; repeat < 10; ++repeat) navigate();
+    countAllocations = false;
+    EXPECT_EQ(allocationCount, size_t{ 0 });
+    EXPECT_EQ(menu.renderFrame(undoPath), "\n1. File\n2. Edit\n1. Undo\n[1-2 of 3]");
+}
+
+TEST(TestconsoleMenu, TestSteadyStateAllocations) {
+    Menu menu{};
+    testSteadyStateAllocations(menu);
+    PooledMenu pooledMenu{};
+    testSteadyStateAllocations(pooledMenu);
+}
+
+TEST(TestconsoleMenu, TestRunBatch) {
+    Menu menu{};
+    addTestMenuItems(menu);
+
+    istringstream selections{ "1 2 b b b 9 /undo x 1 q 3" };
+    ostringstream record{};
+    auto result = menu.runBatch(selections, record, consoleMenu::BatchRecord::FinalState);
+    EXPECT_EQ(result.finalPath, std::vector<unsigned short>({ 1, 0 }));
+    EXPECT_EQ(result.steps, 10u); // Nothing after 'q' is read
+    ASSERT_EQ(result.invalidSelections.size(), 4u);
+    EXPECT_EQ(result.invalidSelections[0].step, 5u);
+    EXPECT_EQ(result.invalidSelections[0].outcome, consoleMenu::OptionOutcome::AtTopLevel);
+    EXPECT_EQ(result.invalidSelections[1].selection, "9");
+    EXPECT_EQ(result.invalidSelections[2].selection, "x");
+    EXPECT_EQ(result.invalidSelections[3].selection, "1"); // Undo has no children
+    EXPECT_EQ(record.str(), "final\t10\t4\t1-0\n");
+
+    PooledMenu pooledMenu{};
+    addTestMenuItems(pooledMenu);
+    istringstream pooledSelections{ "2\n1\nb\n" };
+    ostringstream pooledRecord{};
+    auto pooledResult = pooledMenu.runBatch(pooledSelections, pooledRecord, consoleMenu::BatchRecord::PerStep);
+    EXPECT_EQ(pooledResult.finalPath, std::vector<unsigned short>({ 1 }));
+    EXPECT_TRUE(pooledResult.invalidSelections.empty());
+    EXPECT_EQ(pooledRecord.str(), "1\t2\tmoved\t1\n2\t1\tmoved\t1-0\n3\tb\tmoved\t1\nfinal\t3\t0\t1\n");
+}
+
+TEST(TestconsoleMenu, TestHandleKey) {
+    using osUtils::Key;
+    using consoleMenu::OptionOutcome;
+    PooledMenu menu{};
+    addTestMenuItems(menu);
+    menu.resetCursor();
+
+    EXPECT_EQ(menu.handleKey({ Key::End }), OptionOutcome::Highlighted);
+    EXPECT_EQ(menu.keyInput.highlight, 2u);
+    EXPECT_EQ(menu.handleKey({ Key::Up }), OptionOutcome::Highlighted);
+    EXPECT_EQ(menu.handleKey({ Key::Enter }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1 }));
+    EXPECT_EQ(menu.handleKey({ Key::Left }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.keyInput.highlight, 1u); // Back on the node we left
+
+    // A single digit is enough with fewer than ten options
+    EXPECT_EQ(menu.handleKey({ Key::Character, '1' }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.handleKey({ Key::Character, '2' }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 0, 1 }));
+    EXPECT_EQ(menu.handleKey({ Key::Character, 'b' }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.handleKey({ Key::Character, 'x' }), OptionOutcome::InvalidOption);
+
+    for (char c : string("/und")) EXPECT_FALSE(menu.handleKey({ Key::Character, c }).has_value());
+    EXPECT_FALSE(menu.handleKey({ Key::Backspace }).has_value());
+    EXPECT_FALSE(menu.handleKey({ Key::Character, 'd' }).has_value());
+    ostringstream prompt{};
+    menu.writeKeyPrompt(prompt);
+    EXPECT_EQ(prompt.str(), "\n> 2. Save /und");
+    EXPECT_EQ(menu.handleKey({ Key::Enter }), OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+    EXPECT_EQ(menu.handleKey({ Key::EndOfInput }), OptionOutcome::Quit);
+
+    // With ten or more options a first digit of 1 waits for a second one
+    Menu wideMenu{};
+    for (int item = 1; item <= 12; ++item) wideMenu.addChildNodeAtPath({}, { "Entry " + std::to_string(item) });
+    wideMenu.addChildNodeAtPath(std::vector<unsigned short>{ 10 }, { "Below" });
+    wideMenu.resetCursor();
+    EXPECT_FALSE(wideMenu.handleKey({ Key::Character, '1' }).has_value());
+    EXPECT_EQ(wideMenu.handleKey({ Key::Character, '1' }), OptionOutcome::Moved);
+    EXPECT_EQ(wideMenu.currentMenuPath, std::vector<unsigned short>({ 10 }));
+}
+
+#if defined(__linux__)
+TEST(TestosUtils, TestEventLoop) {
+    using namespace std::chrono_literals;
+    osUtils::EventLoop loop{};
+    std::string order{};
+    auto sleeper = [&loop, &order](std::chrono::milliseconds duration, char name) -> osUtils::Task {
+        co_await loop.sleepFor(duration);
+        order += name;
+    };
+    auto slow = sleeper(6ms, 's');
+    auto fast = sleeper(2ms, 'f');
+    auto cancelled = sleeper(4ms, 'c');
+    cancelled = sleeper(0ms, 'z'); // Destroying a waiting task cancels its timer
+    loop.run();
+    EXPECT_EQ(order, "zfs");
+    EXPECT_TRUE(slow.done() && fast.done());
+    EXPECT_FALSE(loop.hasWaiters());
+}
+
+TEST(TestconsoleMenu, TestdisplayMenuAsync) {
+    using namespace std::chrono_literals;
+    Menu menu{};
+    addTestMenuItems(menu);
+    int pipeFds[2];
+    ASSERT_EQ(pipe(pipeFds), 0);
+
+    osUtils::EventLoop loop{};
+    ostringstream ostrstream{};
+    auto menuTask = menu.displayMenuAsync(loop, pipeFds[0], ostrstream);
+
+    // Input trickles in from a coroutine on the same thread while another one ticks
+    auto writer = [&loop](int fd) -> osUtils::Task {
+        co_await loop.sleepFor(2ms);
+        EXPECT_EQ(write(fd, "2\n", 2), 2);
+        co_await loop.sleepFor(2ms);
+        EXPECT_EQ(write(fd, "x\n1\nq\n", 6), 6);
+    };
+    int ticks = 0;
+    auto ticker = [&loop, &ticks, &menuTask]() -> osUtils::Task {
+        while (!menuTask.done()) {
+            ++ticks;
+            co_await loop.sleepFor(1ms);
+        }
+    };
+    auto writerTask = writer(pipeFds[1]);
+    auto tickerTask = ticker();
+    loop.run();
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+
+    EXPECT_TRUE(menuTask.done());
+    menuTask.rethrowIfFailed();
+    EXPECT_GE(ticks, 3);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+    string prompt{ menu.userPrompt() };
+    EXPECT_EQ(ostrstream.str(),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt +
+        string(menu.userOptionInvalid()) + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt);
+}
+
+TEST(TestconsoleMenu, TestdisplayMenuAsyncFromFile) {
+    Menu menu{};
+    addTestMenuItems(menu);
+    string inputPath = "/tmp/testConsoleMenu." + std::to_string(getpid()) + ".input";
+    int inputFd = open(inputPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    ASSERT_GE(inputFd, 0);
+    EXPECT_EQ(write(inputFd, "2\nx\n1\nq\n", 8), 8);
+    lseek(inputFd, 0, SEEK_SET);
+
+    // epoll refuses regular files, so the loop treats them as always readable
+    osUtils::EventLoop loop{};
+    ostringstream ostrstream{};
+    auto menuTask = menu.displayMenuAsync(loop, inputFd, ostrstream);
+    loop.run();
+    close(inputFd);
+    unlink(inputPath.c_str());
+
+    EXPECT_TRUE(menuTask.done());
+    menuTask.rethrowIfFailed();
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 1, 0 }));
+    string prompt{ menu.userPrompt() };
+    EXPECT_EQ(ostrstream.str(),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt +
+        string(menu.userOptionInvalid()) + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt);
+}
+
+static int connectToSocket(const string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    socketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && 0 != connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address))) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static string readUntilClosed(int fd) {
+    string received{};
+    char chunk[1024];
+    for (ssize_t bytesRead; (bytesRead = read(fd, chunk, sizeof(chunk))) > 0;) received.append(chunk, static_cast<size_t>(bytesRead));
+    return received;
+}
+
+TEST(TestconsoleMenu, TestdisplayMenuWithKeysFallback) {
+    Menu menu{};
+    addTestMenuItems(menu);
+    int pipeFds[2];
+    ASSERT_EQ(pipe(pipeFds), 0);
+    ASSERT_EQ(write(pipeFds[1], "1\nq\n", 4), 4);
+    close(pipeFds[1]);
+
+    // A pipe is no terminal, so the lines are read from it and not from stdin
+    ostringstream ostrstream{};
+    menu.displayMenuWithKeys(ostrstream, pipeFds[0]);
+    close(pipeFds[0]);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 0 }));
+    EXPECT_TRUE(ostrstream.str().ends_with("\n1. File\n1. Open\n2. Save\n2. Edit\n3. Help" + string(menu.userPrompt())));
+}
+
+TEST(TestconsoleMenu, TestMenuServer) {
+    using namespace std::chrono_literals;
+    auto menu = std::make_shared<Menu>();
+    addTestMenuItems(*menu);
+    string socketPath = "/tmp/testConsoleMenu." + std::to_string(getpid()) + ".sock";
+    unlink(socketPath.c_str());
+
+    osUtils::EventLoop loop{};
+    consoleMenu::MenuServer server{ menu, loop, socketPath };
+    int fileClient = connectToSocket(socketPath);
+    int searchClient = connectToSocket(socketPath);
+    ASSERT_GE(fileClient, 0);
+    ASSERT_GE(searchClient, 0);
+    EXPECT_EQ(write(fileClient, "1\nq\n", 4), 4);
+    EXPECT_EQ(write(searchClient, "/Undo\nq\n", 8), 8);
+
+    // Sessions handle their input on the loop, close their socket after 'q' and are freed
+    // without another client having to connect
+    int iterations = 0;
+    do {
+        loop.runOnce(10ms);
+    } while (server.sessionCount() > 0 && ++iterations < 100);
+    EXPECT_EQ(server.sessionCount(), 0u);
+
+    string prompt{ menu->userPrompt() };
+    EXPECT_EQ(readUntilClosed(fileClient),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        "\n1. File\n1. Open\n2. Save\n2. Edit\n3. Help" + prompt);
+    EXPECT_EQ(readUntilClosed(searchClient),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        "\n1. File\n2. Edit\n1. Undo\n3. Help" + prompt);
+    EXPECT_TRUE(menu->currentMenuPath.empty());
+    close(fileClient);
+    close(searchClient);
+}
+
+TEST(TestconsoleMenu, TestMenuServerSlowClient) {
+    using namespace std::chrono_literals;
+    auto menu = std::make_shared<Menu>();
+    addTestMenuItems(*menu);
+    string socketPath = "/tmp/testConsoleMenu.slow." + std::to_string(getpid()) + ".sock";
+    unlink(socketPath.c_str());
+
+    osUtils::EventLoop loop{};
+    consoleMenu::MenuServer server{ menu, loop, socketPath };
+    int stalledClient = connectToSocket(socketPath);
+    int fileClient = connectToSocket(socketPath);
+    ASSERT_GE(stalledClient, 0);
+    ASSERT_GE(fileClient, 0);
+
+    // The stalled client never reads, so its frames soon fill the socket and wait in its session
+    string selections{};
+    for (int selection = 0; selection < 4000; ++selection) selections += "1\nb\n";
+    EXPECT_EQ(send(stalledClient, selections.data(), selections.size(), MSG_NOSIGNAL), static_cast<ssize_t>(selections.size()));
+    for (int iteration = 0; iteration < 10; ++iteration) loop.runOnce(10ms);
+
+    EXPECT_EQ(write(fileClient, "1\nq\n", 4), 4);
+    for (int iteration = 0; iteration < 100 && server.sessionCount() > 1; ++iteration) loop.runOnce(10ms);
+    EXPECT_EQ(server.sessionCount(), 1u);
+    string prompt{ menu->userPrompt() };
+    EXPECT_EQ(readUntilClosed(fileClient),
+        "\n1. File\n2. Edit\n3. Help" + prompt +
+        "\n1. File\n1. Open\n2. Save\n2. Edit\n3. Help" + prompt);
+
+    // Once it is more than MAX_PENDING bytes behind it is disconnected
+    for (int iteration = 0; iteration < 1000 && server.sessionCount() > 0; ++iteration) {
+        send(stalledClient, selections.data(), selections.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+        loop.runOnce(1ms);
+    }
+    EXPECT_EQ(server.sessionCount(), 0u);
+    close(stalledClient);
+    close(fileClient);
+}
+
+// Reads every token, line and skipped line of source in a fixed order of calls
+template <ioUtils::InputSource Source>
+static std::vector<string> readScript(Source& source) {
+    std::vector<string> reads{};
+    auto record = [&reads](std::optional<string_view> read) { reads.push_back(read ? "[" + string{ *read } + "]" : "none"); };
+    for (int line = 0; line < 4; ++line) {
+        reads.push_back(source.hasUnextractedInput() ? "more" : "newline or end");
+        record(source.readToken());
+        record(source.readToken());
+        source.skipLine();
+        record(source.readLine());
+    }
+    return reads;
+}
+
+TEST(TestuserInput, TestFdInputSource) {
+    string input{ "12345678901234567890 7 rest\n  abc x\n\n42\n  line with spaces \nlast 1" };
+    int pipeFds[2];
+    ASSERT_EQ(pipe(pipeFds), 0);
+    ASSERT_EQ(write(pipeFds[1], input.data(), input.size()), static_cast<ssize_t>(input.size()));
+    close(pipeFds[1]);
+
+    // A buffer shorter than the tokens makes it refill and grow mid token
+    ioUtils::FdInputSource fdSource{ pipeFds[0], 4 };
+    istringstream is{ input };
+    ioUtils::StreamInputSource streamSource{ is };
+    auto reads = readScript(fdSource);
+    EXPECT_EQ(reads[1], "[12345678901234567890]");
+    EXPECT_EQ(reads[3], "[  abc x]");
+    EXPECT_EQ(reads, readScript(streamSource));
+    close(pipeFds[0]);
+
+    // The pipeline and runBatch read the same from both sources
+    ASSERT_EQ(pipe(pipeFds), 0);
+    string selections{ "x\n5\n2 b 9\n1 2 q 3" };
+    ASSERT_EQ(write(pipeFds[1], selections.data(), selections.size()), static_cast<ssize_t>(selections.size()));
+    close(pipeFds[1]);
+    ioUtils::FdInputSource selectionSource{ pipeFds[0], 3 };
+    ostringstream ostrstream{};
+    auto number = ioUtils::getValidInput(
+        [](std::ostream& os) { os << "?"; },
+        [](std::ostream& os) { os << "!"; },
+        [](std::ostream&) {},
+        [](string_view) { return true; },
+        ioUtils::parseNumber<int>,
+        [](const std::optional<int>& number) { return number.has_value(); },
+        selectionSource,
+        ostrstream
+    );
+    EXPECT_EQ(number, std::optional<std::optional<int>>{ 5 });
+    EXPECT_EQ(ostrstream.str(), "?!?");
+
+    Menu menu{};
+    addTestMenuItems(menu);
+    ostringstream record{};
+    auto result = menu.runBatch(selectionSource, record, consoleMenu::BatchRecord::FinalState);
+    EXPECT_EQ(result.steps, 6u);
+    ASSERT_EQ(result.invalidSelections.size(), 1u);
+    EXPECT_EQ(result.invalidSelections[0].selection, "9");
+    EXPECT_EQ(record.str(), "final\t6\t1\t0-1\n");
+    close(pipeFds[0]);
+}
+#endif
+
+TEST(TestconsoleMenu, TestSnapshotMenu) {
+    using consoleMenu::MenuSnapshots;
+    using consoleMenu::SnapshotMenu;
+    using consoleMenu::SnapshotMenuTree;
+    static constexpr unsigned short writerCount = 4;
+    static constexpr unsigned short itemsPerWriter = 200;
+    auto snapshots = std::make_shared<MenuSnapshots>();
+    auto firstVersion = snapshots->latest();
+
+    // Writers extend the tree while a renderer keeps moving to the latest version;
+    // every version it sees has to be whole and no smaller than the one before
+    std::atomic<bool> rendering{ false };
+    std::atomic<unsigned short> writersDone{ 0 };
+    std::vector<std::thread> writers{};
+    for (unsigned short writer = 0; writer < writerCount; ++writer) {
+        writers.emplace_back([&snapshots, &rendering, &writersDone, writer]() {
+            while (!rendering) std::this_thread::yield();
+            auto index = snapshots->addChild({}, { "Writer " + std::to_string(writer) });
+            std::vector<unsigned short> path{ index.value() };
+            for (unsigned short item = 0; item < itemsPerWriter; ++item) snapshots->addChild(path, { "Item " + std::to_string(item) });
+            ++writersDone;
+        });
+    }
+
+    SnapshotMenu menu{ SnapshotMenuTree{ snapshots } };
+    size_t previousNodeCount = 0;
+    size_t versionsSeen = 0;
+    bool consistent = true;
+    rendering = true;
+    while (writersDone < writerCount) {
+        if (!menu.refreshTree()) continue;
+        ++versionsSeen;
+        size_t nodeCount = 0;
+        menu.tree.forEachChild(menu.tree.rootNode(), [&menu, &nodeCount](auto writerNode) { nodeCount += 1 + menu.tree.childCount(writerNode); });
+        consistent = consistent && nodeCount >= previousNodeCount;
+        previousNodeCount = nodeCount;
+        auto rootChildren = menu.tree.childCount(menu.tree.rootNode());
+        if (rootChildren > 0) {
+            std::vector<unsigned short> path{ static_cast<unsigned short>(versionsSeen % rootChildren) };
+            auto frame = menu.renderFrame(path);
+            auto itemCount = menu.tree.childCount(menu.tree.childAt(menu.tree.rootNode(), path[0]).value());
+            consistent = consistent && static_cast<size_t>(std::count(frame.begin(), frame.end(), '\n')) == rootChildren + itemCount;
+        }
+    }
+    for (auto& writer : writers) writer.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(firstVersion->children.size(), 0u); // Published versions never change
+    menu.refreshTree();
+    EXPECT_EQ(menu.tree.childCount(menu.tree.rootNode()), writerCount);
+    menu.tree.forEachChild(menu.tree.rootNode(), [&menu](auto writerNode) { EXPECT_EQ(menu.tree.childCount(writerNode), itemsPerWriter); });
+
+    // Options are applied to the latest version, which the search index follows
+    snapshots->addChild({}, { "Late" });
+    EXPECT_EQ(menu.applyUserInput("5"), consoleMenu::OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 4 }));
+    EXPECT_EQ(menu.findNode("Late"), std::vector<unsigned short>({ 4 }));
+}
+
+TEST(TestconsoleMenu, TestSnapshotMenuOverPublishedVersion) {
+    using consoleMenu::MenuSnapshots;
+    using consoleMenu::SnapshotMenu;
+    using consoleMenu::SnapshotMenuTree;
+    auto snapshots = std::make_shared<MenuSnapshots>();
+    auto file = snapshots->addChild({}, { "File" });
+    std::vector<unsigned short> filePath{ file.value() };
+    snapshots->addChild(filePath, { "Save as" });
+    snapshots->addChild({}, { "Edit" });
+
+    // Nothing is published after the menu is made, so the first search has to index what is already there
+    SnapshotMenu menu{ SnapshotMenuTree{ snapshots } };
+    EXPECT_EQ(menu.findNode("save"), std::vector<unsigned short>({ 0, 0 }));
+    EXPECT_EQ(menu.findNode("edit"), std::vector<unsigned short>({ 1 }));
+    EXPECT_EQ(menu.applyUserInput("/save"), consoleMenu::OptionOutcome::Moved);
+    EXPECT_EQ(menu.currentMenuPath, std::vector<unsigned short>({ 0, 0 }));
+}